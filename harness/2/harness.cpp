@@ -2,10 +2,10 @@
 #include <iostream>
 #include <vector>
 
-#include <LIEF/ELF.hpp>
 #include <triton/context.hpp>
 #include <triton/cpuSize.hpp>
 
+#include <loader.hpp>
 #include <ttexplore.hpp>
 
 
@@ -18,17 +18,16 @@ int main(int ac, const char *av[]) {
     return -1;
   }
 
-  std::unique_ptr<const LIEF::ELF::Binary> binary{LIEF::ELF::Parser::parse(av[1])};
-  for (const LIEF::ELF::Segment& s : binary->segments()) {
-    std::vector<triton::uint8> data;
-    data.insert(data.begin(), s.content().begin(), s.content().end());
+  /* Lazily map the segments of the binary into the Triton's memory */
+  triton::loaders::ElfLoader loader(av[1]);
+  for (const auto& s : loader.getSegments()) {
     std::cout << "[+] Mapping "
-              << std::hex << std::setw(16) << std::setfill('0') << s.virtual_address()
+              << std::hex << std::setw(16) << std::setfill('0') << s.vaddr
               << " "
-              << std::hex << std::setw(16) << std::setfill('0') << s.virtual_address() + s.virtual_size()
+              << std::hex << std::setw(16) << std::setfill('0') << s.vaddr + s.vsize
               << std::endl;
-    ctx.setConcreteMemoryAreaValue(s.virtual_address(), data);
   }
+  loader.map(&ctx);
 
   /* Setup mode */
   ctx.setMode(triton::modes::ALIGNED_MEMORY, true);
@@ -47,6 +46,7 @@ int main(int ac, const char *av[]) {
   /* Start exploration */
   triton::engines::exploration::SymbolicExplorator explorator;
   explorator.initContext(&ctx);
+  explorator.initLoader(&loader);
   explorator.explore();
   //explorator.dumpCoverage();
 
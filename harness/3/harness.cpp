@@ -2,11 +2,11 @@
 #include <iostream>
 #include <vector>
 
-#include <LIEF/ELF.hpp>
 #include <triton/context.hpp>
 #include <triton/cpuSize.hpp>
 #include <triton/stubs.hpp>
 
+#include <loader.hpp>
 #include <ttexplore.hpp>
 
 const triton::uint64 base_libc = 0x66600000;
@@ -21,17 +21,16 @@ int main(int ac, const char *av[]) {
     return -1;
   }
 
-  std::unique_ptr<const LIEF::ELF::Binary> binary{LIEF::ELF::Parser::parse(av[1])};
-  for (const LIEF::ELF::Segment& s : binary->segments()) {
-    std::vector<triton::uint8> data;
-    data.insert(data.begin(), s.content().begin(), s.content().end());
+  /* Lazily map the segments of the binary into the Triton's memory */
+  triton::loaders::ElfLoader loader(av[1]);
+  for (const auto& s : loader.getSegments()) {
     std::cout << "[+] Mapping "
-              << std::hex << std::setw(16) << std::setfill('0') << s.virtual_address()
+              << std::hex << std::setw(16) << std::setfill('0') << s.vaddr
               << " "
-              << std::hex << std::setw(16) << std::setfill('0') << s.virtual_address() + s.virtual_size()
+              << std::hex << std::setw(16) << std::setfill('0') << s.vaddr + s.vsize
               << std::endl;
-    ctx.setConcreteMemoryAreaValue(s.virtual_address(), data);
   }
+  loader.map(&ctx);
 
   /* Map the stub of libc at 0x66600000 */
   ctx.setConcreteMemoryAreaValue(base_libc, triton::stubs::x8664::systemv::libc::code);
@@ -56,6 +55,7 @@ int main(int ac, const char *av[]) {
   /* Start exploration */
   triton::engines::exploration::SymbolicExplorator explorator;
   explorator.initContext(&ctx);
+  explorator.initLoader(&loader);
   explorator.explore();
   //explorator.dumpCoverage();
 
@@ -1,12 +1,14 @@
 #include <map>
+#include <memory>
 #include <iostream>
 #include <vector>
 
-#include <LIEF/ELF.hpp>
 #include <triton/context.hpp>
 #include <triton/cpuSize.hpp>
 #include <triton/stubs.hpp>
 
+#include <image.hpp>
+#include <loader.hpp>
 #include <ttexplore.hpp>
 #include <routines.hpp>
 
@@ -16,55 +18,88 @@ std::map<std::string, triton::uint64> custom_plt = {
   {"printf", 1},
 };
 
+/* Routines bound again by name when the state is loaded from an image */
+std::map<std::string, triton::callbacks::cb_state_e(*)(triton::Context*)> routines = {
+  {"printf", triton::routines::printf},
+};
+
+
+static void usage(const char* name) {
+  std::cerr << "Usage: " << name << " <binary> [--save-image <image>]" << std::endl;
+  std::cerr << "       " << name << " --image <image>" << std::endl;
+}
+
 
 int main(int ac, const char *av[]) {
   /* Init the triton context */
   triton::Context ctx(triton::arch::ARCH_X86_64);
   ctx.setSolver(triton::engines::solver::SOLVER_BITWUZLA);
 
-  if (ac != 2) {
-    std::cerr << "Usage: " << av[0] << " <binary>" << std::endl;
-    return -1;
-  }
+  std::unique_ptr<triton::loaders::ElfLoader> loader;
+  std::unique_ptr<triton::loaders::Image> image;
+  std::map<triton::uint64, std::string> hooks;
 
-  /* Use LIEF to load segment into the Triton's memory */
-  std::unique_ptr<const LIEF::ELF::Binary> binary{LIEF::ELF::Parser::parse(av[1])};
-  for (const LIEF::ELF::Segment& s : binary->segments()) {
-    std::vector<triton::uint8> data;
-    data.insert(data.begin(), s.content().begin(), s.content().end());
-    std::cout << "[+] Mapping "
-              << std::hex << std::setw(16) << std::setfill('0') << s.virtual_address()
-              << " "
-              << std::hex << std::setw(16) << std::setfill('0') << s.virtual_address() + s.virtual_size()
-              << std::endl;
-    ctx.setConcreteMemoryAreaValue(s.virtual_address(), data);
+  if (ac == 3 && std::string(av[1]) == "--image") {
+    /* The state prepared below has been saved into an image, its pages are mapped lazily */
+    image = std::make_unique<triton::loaders::Image>(av[2]);
+    image->restore(&ctx);
+    hooks = image->getHooks();
   }
+  else if (ac == 2 || (ac == 4 && std::string(av[2]) == "--save-image")) {
+    /* Lazily map the segments of the binary into the Triton's memory */
+    loader = std::make_unique<triton::loaders::ElfLoader>(av[1]);
+    for (const auto& s : loader->getSegments()) {
+      std::cout << "[+] Mapping "
+                << std::hex << std::setw(16) << std::setfill('0') << s.vaddr
+                << " "
+                << std::hex << std::setw(16) << std::setfill('0') << s.vaddr + s.vsize
+                << std::endl;
+    }
+    loader->map(&ctx);
 
-  /* Map the stub of libc at 0x66600000 */
-  ctx.setConcreteMemoryAreaValue(base_libc, triton::stubs::x8664::systemv::libc::code);
-  ctx.setConcreteMemoryValue(triton::arch::MemoryAccess(0x4020, triton::size::qword), custom_plt.at("printf")); // printf
-  ctx.setConcreteMemoryValue(triton::arch::MemoryAccess(0x4028, triton::size::qword), base_libc + triton::stubs::x8664::systemv::libc::symbols.at("none"));   // fprintf
-  ctx.setConcreteMemoryValue(triton::arch::MemoryAccess(0x4030, triton::size::qword), base_libc + triton::stubs::x8664::systemv::libc::symbols.at("memcpy")); // memcpy
+    /* Map the stub of libc at 0x66600000 */
+    ctx.setConcreteMemoryAreaValue(base_libc, triton::stubs::x8664::systemv::libc::code);
+    ctx.setConcreteMemoryValue(triton::arch::MemoryAccess(0x4020, triton::size::qword), custom_plt.at("printf")); // printf
+    ctx.setConcreteMemoryValue(triton::arch::MemoryAccess(0x4028, triton::size::qword), base_libc + triton::stubs::x8664::systemv::libc::symbols.at("none"));   // fprintf
+    ctx.setConcreteMemoryValue(triton::arch::MemoryAccess(0x4030, triton::size::qword), base_libc + triton::stubs::x8664::systemv::libc::symbols.at("memcpy")); // memcpy
 
-  /* Setup mode */
-  ctx.setMode(triton::modes::ALIGNED_MEMORY, true);
-  ctx.setMode(triton::modes::AST_OPTIMIZATIONS, true);
-  ctx.setMode(triton::modes::CONSTANT_FOLDING, true);
+    /* Setup mode */
+    ctx.setMode(triton::modes::ALIGNED_MEMORY, true);
+    ctx.setMode(triton::modes::AST_OPTIMIZATIONS, true);
+    ctx.setMode(triton::modes::CONSTANT_FOLDING, true);
 
-  /* Setup symbolic variable */
-  ctx.symbolizeMemory(0xdead, 40);
+    /* Setup symbolic variable */
+    ctx.symbolizeMemory(0xdead, 40);
 
-  /* Setup the program counter and arguments */
-  ctx.setConcreteRegisterValue(ctx.registers.x86_rip, 0x11DF);
-  ctx.setConcreteRegisterValue(ctx.registers.x86_rdi, 0xdead);
-  ctx.setConcreteRegisterValue(ctx.registers.x86_rsi, 40);
-  ctx.setConcreteRegisterValue(ctx.registers.x86_rsp, 0x7ffffff0);
-  ctx.setConcreteRegisterValue(ctx.registers.x86_rbp, 0x7ffffff0);
+    /* Setup the program counter and arguments */
+    ctx.setConcreteRegisterValue(ctx.registers.x86_rip, 0x11DF);
+    ctx.setConcreteRegisterValue(ctx.registers.x86_rdi, 0xdead);
+    ctx.setConcreteRegisterValue(ctx.registers.x86_rsi, 40);
+    ctx.setConcreteRegisterValue(ctx.registers.x86_rsp, 0x7ffffff0);
+    ctx.setConcreteRegisterValue(ctx.registers.x86_rbp, 0x7ffffff0);
+
+    hooks[custom_plt.at("printf")] = "printf";
+
+    /* Images hold the whole binary, not only the pages touched so far */
+    if (ac == 4) {
+      loader->populate(&ctx);
+      triton::loaders::Image::save(av[3], &ctx, hooks);
+      std::cout << "[+] Image saved into " << av[3] << std::endl;
+      return 0;
+    }
+  }
+  else {
+    usage(av[0]);
+    return -1;
+  }
 
   /* Start exploration */
   triton::engines::exploration::SymbolicExplorator explorator;
   explorator.initContext(&ctx);
-  explorator.hookInstruction(custom_plt.at("printf"), triton::routines::printf);
+  explorator.initLoader(image ? static_cast<triton::loaders::LazyLoader*>(image.get()) : loader.get());
+  for (const auto& hook : hooks) {
+    explorator.hookInstruction(hook.first, routines.at(hook.second));
+  }
   explorator.config.timeout = 60;
   explorator.explore();
   explorator.dumpCoverage();
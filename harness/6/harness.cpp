@@ -1,5 +1,6 @@
 #include <map>
 #include <iostream>
+#include <string>
 
 #include <triton/context.hpp>
 #include <triton/cpuSize.hpp>
@@ -55,6 +56,13 @@ int main(int ac, const char *av[]) {
   triton::engines::exploration::SymbolicExplorator explorator;
   explorator.initContext(&ctx);
   explorator.config.end_point = 0x1181;
+
+  /* Only measure the coverage of an existing corpus */
+  if (ac == 3 && std::string(av[1]) == "--replay") {
+    explorator.replay(av[2]);
+    return 0;
+  }
+
   explorator.explore();
 
   return 0;
@@ -0,0 +1,143 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <deque>
+
+#include <triton/exceptions.hpp>
+
+#include <cfg.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      Cfg::Cfg() {
+        this->dirty = false;
+        this->loader = nullptr;
+      }
+
+
+      void Cfg::setLoader(triton::loaders::LazyLoader* loader) {
+        this->loader = loader;
+      }
+
+
+      void Cfg::addEdge(triton::uint64 src, triton::uint64 dst, triton::uint8 weight) {
+        /* Both weights may exist for the same pair, they are distinct edges */
+        if (this->known.insert(std::make_tuple(src, dst, weight)).second == false)
+          return;
+        this->preds[dst].push_back(std::make_pair(src, weight));
+        this->dirty = true;
+      }
+
+
+      void Cfg::addFlow(triton::Context* ctx, triton::uint64 src, triton::uint64 dst) {
+        this->addEdge(src, dst, 1);
+        if (this->blocks.find(dst) == this->blocks.end()) {
+          this->disassemble(ctx, dst);
+        }
+      }
+
+
+      void Cfg::disassemble(triton::Context* ctx, triton::uint64 addr) {
+        std::vector<triton::uint64> todo = {addr};
+        triton::usize budget = CFG_BLOCK_BUDGET;
+
+        while (todo.size() && budget) {
+          triton::uint64 pc = todo.back();
+          todo.pop_back();
+          if (this->blocks.insert(pc).second == false)
+            continue;
+          budget--;
+
+          for (triton::usize i = 0; i < CFG_BLOCK_SIZE; i++) {
+            /* Map the code if needed, the memory hooks are not run by the disassembly */
+            if (this->loader) {
+              this->loader->load(ctx, pc, 16);
+            }
+            auto opcodes = ctx->getConcreteMemoryAreaValue(pc, 16, false);
+            if (ctx->isConcreteMemoryValueDefined(pc, 1) == false)
+              break;
+
+            triton::arch::Instruction inst(pc, opcodes.data(), opcodes.size());
+            try {
+              ctx->disassembly(inst);
+            }
+            catch (const triton::exceptions::Exception&) {
+              break;
+            }
+
+            triton::uint64 next = pc + inst.getSize();
+            if (inst.isControlFlow() == false) {
+              this->addEdge(pc, next, 0);
+              pc = next;
+              continue;
+            }
+
+            /* Direct targets and fallthrough start new blocks */
+            for (const auto& operand : inst.operands) {
+              if (operand.getType() == triton::arch::OP_IMM) {
+                triton::uint64 target = operand.getConstImmediate().getValue();
+                this->addEdge(pc, target, 1);
+                todo.push_back(target);
+              }
+            }
+            this->addEdge(pc, next, 1);
+            todo.push_back(next);
+            break;
+          }
+        }
+      }
+
+
+      void Cfg::computeDistances(const std::vector<triton::uint64>& targets) {
+        if (this->dirty == false && this->dist.size())
+          return;
+
+        std::deque<triton::uint64> queue;
+        this->dist.clear();
+        for (const auto& target : targets) {
+          this->dist[target] = 0;
+          queue.push_back(target);
+        }
+
+        /* 0-1 BFS, nodes reached through a null weight are processed first */
+        while (queue.size()) {
+          triton::uint64 node = queue.front();
+          queue.pop_front();
+          triton::usize d = this->dist[node];
+          auto it = this->preds.find(node);
+          if (it == this->preds.end())
+            continue;
+          for (const auto& pred : it->second) {
+            triton::usize nd = d + pred.second;
+            auto pit = this->dist.find(pred.first);
+            if (pit != this->dist.end() && pit->second <= nd)
+              continue;
+            this->dist[pred.first] = nd;
+            if (pred.second == 0)
+              queue.push_front(pred.first);
+            else
+              queue.push_back(pred.first);
+          }
+        }
+
+        this->dirty = false;
+      }
+
+
+      triton::usize Cfg::distance(triton::uint64 addr) const {
+        auto it = this->dist.find(addr);
+        if (it == this->dist.end())
+          return CFG_UNREACHABLE;
+        return it->second;
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
@@ -0,0 +1,119 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_CFG_H
+#define TRITON_CFG_H
+
+
+#include <limits>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <triton/context.hpp>
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include <loader.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Distance of an address from which no target is known to be reachable.
+      const triton::usize CFG_UNREACHABLE = std::numeric_limits<triton::usize>::max();
+
+      //! Maximum number of blocks statically disassembled per discovery.
+      const triton::usize CFG_BLOCK_BUDGET = 256;
+
+      //! Maximum number of instructions of a statically disassembled block.
+      const triton::usize CFG_BLOCK_SIZE = 256;
+
+      /*! \class Cfg
+          \brief Control flow graph used to direct the exploration.
+
+          \details Nodes are instructions. An edge between two instructions of a basic block
+          weights 0 and an edge leaving a control flow instruction weights 1, so that the
+          distance between two instructions is a number of basic blocks. Edges come from
+          executed traces (which resolve indirect jumps and returns) and from the static
+          disassembly of the blocks reached by them (which gives the branches not taken
+          yet). The fallthrough of every control flow instruction is assumed, which may
+          underestimate some distances. */
+      class Cfg {
+        private:
+          //! Predecessors of an instruction <dst : [<src, weight>]>.
+          std::unordered_map<triton::uint64, std::vector<std::pair<triton::uint64, triton::uint8>>> preds;
+
+          //! Known edges <src, dst, weight>.
+          std::set<std::tuple<triton::uint64, triton::uint64, triton::uint8>> known;
+
+          //! Start of the blocks already disassembled.
+          std::unordered_set<triton::uint64> blocks;
+
+          //! Distance to the nearest target <addr : distance>.
+          std::unordered_map<triton::uint64, triton::usize> dist;
+
+          //! True if edges have been added since the last distance computation.
+          bool dirty;
+
+          //! Loader mapping the code lazily, if any.
+          triton::loaders::LazyLoader* loader;
+
+          //! Add an edge.
+          void addEdge(triton::uint64 src, triton::uint64 dst, triton::uint8 weight);
+
+        public:
+          //! Constructor.
+          TRITON_EXPORT Cfg();
+
+          //! Set the loader that maps the code before it is disassembled.
+          TRITON_EXPORT void setLoader(triton::loaders::LazyLoader* loader);
+
+          //! Add an edge taken by a control flow instruction and disassemble its destination.
+          TRITON_EXPORT void addFlow(triton::Context* ctx, triton::uint64 src, triton::uint64 dst);
+
+          //! Statically disassemble the blocks reachable from an address.
+          TRITON_EXPORT void disassemble(triton::Context* ctx, triton::uint64 addr);
+
+          //! Compute the distances to the targets with a 0-1 BFS on the reversed graph. Does nothing if the graph did not change.
+          TRITON_EXPORT void computeDistances(const std::vector<triton::uint64>& targets);
+
+          //! Returns the distance, in basic blocks, from an address to the nearest target.
+          TRITON_EXPORT triton::usize distance(triton::uint64 addr) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_CFG_H */
@@ -0,0 +1,140 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <algorithm>
+
+#include <triton/exceptions.hpp>
+
+#include <hooks.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      HookTable::HookTable()
+        : filter(HOOK_FILTER_BITS / 64, 0) {
+        this->attached = nullptr;
+        this->readAttached = false;
+        this->writeAttached = false;
+      }
+
+
+      void HookTable::mark(triton::uint64 lo, triton::uint64 hi) {
+        triton::uint64 first = lo / HOOK_PAGE_SIZE;
+        triton::uint64 last  = (hi - 1) / HOOK_PAGE_SIZE;
+
+        /* The range wraps the whole filter */
+        if (last - first >= HOOK_FILTER_BITS) {
+          std::fill(this->filter.begin(), this->filter.end(), ~0ULL);
+          return;
+        }
+
+        for (triton::uint64 page = first; page <= last; page++) {
+          triton::uint64 bit = page % HOOK_FILTER_BITS;
+          this->filter[bit / 64] |= (1ULL << (bit % 64));
+        }
+      }
+
+
+      void HookTable::addInstruction(triton::uint64 addr, instCallback fn) {
+        this->insts.insert(std::pair<triton::uint64, instCallback>(addr, fn));
+        this->mark(addr, addr + 1);
+      }
+
+
+      void HookTable::addRange(triton::uint64 lo, triton::uint64 hi, instCallback fn) {
+        if (lo >= hi) {
+          throw triton::exceptions::Engines("HookTable::addRange(): Invalid range");
+        }
+        this->ranges.push_back({lo, hi, fn});
+        this->mark(lo, hi);
+      }
+
+
+      void HookTable::addMemoryRead(triton::uint64 lo, triton::uint64 hi, memReadCallback fn) {
+        if (lo >= hi) {
+          throw triton::exceptions::Engines("HookTable::addMemoryRead(): Invalid range");
+        }
+        this->reads.push_back({lo, hi, fn});
+      }
+
+
+      void HookTable::addMemoryWrite(triton::uint64 lo, triton::uint64 hi, memWriteCallback fn) {
+        if (lo >= hi) {
+          throw triton::exceptions::Engines("HookTable::addMemoryWrite(): Invalid range");
+        }
+        this->writes.push_back({lo, hi, fn});
+      }
+
+
+      const instCallback* HookTable::lookup(triton::uint64 addr) const {
+        auto it = this->insts.find(addr);
+        if (it != this->insts.end()) {
+          return &it->second;
+        }
+        for (const auto& range : this->ranges) {
+          if (addr >= range.lo && addr < range.hi) {
+            return &range.cb;
+          }
+        }
+        return nullptr;
+      }
+
+
+      void HookTable::onMemoryRead(triton::Context& ctx, const triton::arch::MemoryAccess& mem) {
+        triton::uint64 lo = mem.getAddress();
+        triton::uint64 hi = lo + mem.getSize();
+        for (const auto& hook : this->reads) {
+          if (lo < hook.hi && hook.lo < hi) {
+            hook.cb(&ctx, mem);
+          }
+        }
+      }
+
+
+      void HookTable::onMemoryWrite(triton::Context& ctx, const triton::arch::MemoryAccess& mem, const triton::uint512& value) {
+        triton::uint64 lo = mem.getAddress();
+        triton::uint64 hi = lo + mem.getSize();
+        for (const auto& hook : this->writes) {
+          if (lo < hook.hi && hook.lo < hi) {
+            hook.cb(&ctx, mem, value);
+          }
+        }
+      }
+
+
+      void HookTable::attach(triton::Context* ctx) {
+        if (this->attached != ctx) {
+          this->attached = ctx;
+          this->readAttached = false;
+          this->writeAttached = false;
+        }
+
+        if (this->reads.size() && this->readAttached == false) {
+          this->readAttached = true;
+          ctx->addCallback(triton::callbacks::GET_CONCRETE_MEMORY_VALUE,
+            triton::ComparableFunctor<void(triton::Context&, const triton::arch::MemoryAccess&)>(
+              [this](triton::Context& ctx, const triton::arch::MemoryAccess& mem) { this->onMemoryRead(ctx, mem); },
+              &this->reads
+            )
+          );
+        }
+        if (this->writes.size() && this->writeAttached == false) {
+          this->writeAttached = true;
+          ctx->addCallback(triton::callbacks::SET_CONCRETE_MEMORY_VALUE,
+            triton::ComparableFunctor<void(triton::Context&, const triton::arch::MemoryAccess&, const triton::uint512&)>(
+              [this](triton::Context& ctx, const triton::arch::MemoryAccess& mem, const triton::uint512& value) { this->onMemoryWrite(ctx, mem, value); },
+              &this->writes
+            )
+          );
+        }
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
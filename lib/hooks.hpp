@@ -0,0 +1,164 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_HOOKS_H
+#define TRITON_HOOKS_H
+
+
+#include <unordered_map>
+#include <vector>
+
+#include <triton/comparableFunctor.hpp>
+#include <triton/context.hpp>
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Callbacks namespace
+  namespace callbacks {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup callbacks
+   *  @{
+   */
+
+    //! State of callback
+    enum cb_state_e {
+      CONTINUE,
+      BREAK,
+      PLT_CONTINUE,
+    };
+
+  };
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Instruction callback signature
+      using instCallback = triton::ComparableFunctor<triton::callbacks::cb_state_e(triton::Context*)>;
+
+      //! Memory read callback signature, called before the access is performed
+      using memReadCallback = triton::ComparableFunctor<void(triton::Context*, const triton::arch::MemoryAccess&)>;
+
+      //! Memory write callback signature, called when the value is written
+      using memWriteCallback = triton::ComparableFunctor<void(triton::Context*, const triton::arch::MemoryAccess&, const triton::uint512&)>;
+
+      //! Number of bits of the page filter
+      const triton::usize HOOK_FILTER_BITS = 1 << 20;
+
+      //! Size of a page of the filter
+      const triton::usize HOOK_PAGE_SIZE = 0x1000;
+
+      //! A hook on the range [lo, hi)
+      template <typename T>
+      struct hook_range_s {
+        triton::uint64 lo;
+        triton::uint64 hi;
+        T cb;
+      };
+
+      /*! \class HookTable
+          \brief Instruction, range and memory hooks.
+
+          \details Each hooked page sets one bit of a fixed size filter indexed by page number.
+          Unhooked instructions only cost one bit test, the exact lookup is done when the bit
+          is set. Memory hooks are dispatched through the GET_CONCRETE_MEMORY_VALUE and
+          SET_CONCRETE_MEMORY_VALUE callbacks of the context. A memory callback that accesses
+          the memory of the context must do it with `execCallbacks` set to `false`. */
+      class HookTable {
+        private:
+          //! The page filter of instruction and range hooks.
+          std::vector<triton::uint64> filter;
+
+          //! Instruction hooks <addr : cb>.
+          std::unordered_map<triton::uint64, instCallback> insts;
+
+          //! Range hooks, the first registered wins on overlap.
+          std::vector<hook_range_s<instCallback>> ranges;
+
+          //! Memory read hooks.
+          std::vector<hook_range_s<memReadCallback>> reads;
+
+          //! Memory write hooks.
+          std::vector<hook_range_s<memWriteCallback>> writes;
+
+          //! Context whose callbacks dispatch the memory hooks.
+          triton::Context* attached;
+
+          //! True if the read (resp. write) dispatcher is registered into the attached context.
+          bool readAttached;
+          bool writeAttached;
+
+          //! Mark the pages of [lo, hi) into the filter.
+          void mark(triton::uint64 lo, triton::uint64 hi);
+
+          //! Dispatch a memory read to the read hooks.
+          void onMemoryRead(triton::Context& ctx, const triton::arch::MemoryAccess& mem);
+
+          //! Dispatch a memory write to the write hooks.
+          void onMemoryWrite(triton::Context& ctx, const triton::arch::MemoryAccess& mem, const triton::uint512& value);
+
+        public:
+          //! Constructor.
+          TRITON_EXPORT HookTable();
+
+          //! Hook an instruction.
+          TRITON_EXPORT void addInstruction(triton::uint64 addr, instCallback fn);
+
+          //! Hook every instruction of [lo, hi).
+          TRITON_EXPORT void addRange(triton::uint64 lo, triton::uint64 hi, instCallback fn);
+
+          //! Hook memory reads overlapping [lo, hi).
+          TRITON_EXPORT void addMemoryRead(triton::uint64 lo, triton::uint64 hi, memReadCallback fn);
+
+          //! Hook memory writes overlapping [lo, hi).
+          TRITON_EXPORT void addMemoryWrite(triton::uint64 lo, triton::uint64 hi, memWriteCallback fn);
+
+          //! Register the memory hooks into the context. Dispatchers already registered are not added again.
+          TRITON_EXPORT void attach(triton::Context* ctx);
+
+          //! Returns the hook of an instruction, nullptr if none.
+          inline const instCallback* find(triton::uint64 addr) const {
+            triton::uint64 bit = (addr / HOOK_PAGE_SIZE) % HOOK_FILTER_BITS;
+            if ((this->filter[bit / 64] & (1ULL << (bit % 64))) == 0) {
+              return nullptr;
+            }
+            return this->lookup(addr);
+          }
+
+          //! Returns the hook of an instruction without the filter, nullptr if none.
+          TRITON_EXPORT const instCallback* lookup(triton::uint64 addr) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_HOOKS_H */
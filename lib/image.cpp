@@ -0,0 +1,252 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include <triton/exceptions.hpp>
+
+#include <image.hpp>
+
+
+
+namespace triton {
+  namespace loaders {
+
+    /* Modes saved into images, bit i of the header is the i-th mode */
+    static const triton::modes::mode_e IMAGE_MODES[] = {
+      triton::modes::ALIGNED_MEMORY,
+      triton::modes::AST_OPTIMIZATIONS,
+      triton::modes::CONCRETIZE_UNDEFINED_REGISTERS,
+      triton::modes::CONSTANT_FOLDING,
+      triton::modes::MEMORY_ARRAY,
+      triton::modes::ONLY_ON_SYMBOLIZED,
+      triton::modes::ONLY_ON_TAINTED,
+      triton::modes::PC_TRACKING_SYMBOLIC,
+      triton::modes::SYMBOLIZE_INDEX_ROTATION,
+      triton::modes::SYMBOLIZE_LOAD,
+      triton::modes::SYMBOLIZE_STORE,
+      triton::modes::TAINT_THROUGH_POINTERS,
+    };
+
+
+    Image::Image(const std::string& path) {
+      struct stat st;
+
+      this->fd = open(path.c_str(), O_RDONLY);
+      if (this->fd < 0 || fstat(this->fd, &st) != 0) {
+        throw triton::exceptions::Engines("Image::Image(): Cannot open " + path);
+      }
+
+      this->areaSize = st.st_size;
+      void* area = (this->areaSize >= sizeof(image_header_s)) ? mmap(nullptr, this->areaSize, PROT_READ, MAP_PRIVATE, this->fd, 0) : MAP_FAILED;
+      if (area == MAP_FAILED) {
+        close(this->fd);
+        throw triton::exceptions::Engines("Image::Image(): Cannot mmap " + path);
+      }
+      this->area = static_cast<const triton::uint8*>(area);
+
+      this->header = reinterpret_cast<const image_header_s*>(this->area);
+      this->regs   = reinterpret_cast<const image_reg_s*>(this->header + 1);
+      this->vars   = reinterpret_cast<const image_var_s*>(this->regs + this->header->nregs);
+      this->hooks  = reinterpret_cast<const image_hook_s*>(this->vars + this->header->nvars);
+      this->pages  = reinterpret_cast<const image_page_s*>(this->hooks + this->header->nhooks);
+
+      triton::usize size = sizeof(image_header_s)
+                         + this->header->nregs  * sizeof(image_reg_s)
+                         + this->header->nvars  * sizeof(image_var_s)
+                         + this->header->nhooks * sizeof(image_hook_s)
+                         + this->header->npages * sizeof(image_page_s);
+
+      if (std::memcmp(this->header->magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || size != this->areaSize) {
+        munmap(const_cast<triton::uint8*>(this->area), this->areaSize);
+        close(this->fd);
+        throw triton::exceptions::Engines("Image::Image(): Invalid image " + path);
+      }
+    }
+
+
+    Image::~Image() {
+      munmap(const_cast<triton::uint8*>(this->area), this->areaSize);
+      close(this->fd);
+    }
+
+
+    triton::arch::architecture_e Image::getArchitecture(void) const {
+      return static_cast<triton::arch::architecture_e>(this->header->arch);
+    }
+
+
+    void Image::restore(triton::Context* ctx) {
+      if (ctx->getArchitecture() != this->getArchitecture()) {
+        ctx->setArchitecture(this->getArchitecture());
+      }
+
+      for (triton::usize i = 0; i < sizeof(IMAGE_MODES) / sizeof(IMAGE_MODES[0]); i++) {
+        ctx->setMode(IMAGE_MODES[i], (this->header->modes >> i) & 1);
+      }
+
+      /* Pages are copied from the mapping on first read */
+      this->map(ctx);
+
+      for (triton::uint32 i = 0; i < this->header->nregs; i++) {
+        const auto& reg = this->regs[i];
+        triton::uint512 value = 0;
+        for (triton::uint32 j = reg.size; j > 0; j--) {
+          value = (value << 8) | reg.value[j - 1];
+        }
+        ctx->setConcreteRegisterValue(ctx->getRegister(static_cast<triton::arch::register_e>(reg.id)), value, false);
+      }
+
+      /* Variables take the concrete values restored above, their pages are copied first */
+      for (triton::uint32 i = 0; i < this->header->nvars; i++) {
+        const auto& var = this->vars[i];
+        std::string alias(var.alias, strnlen(var.alias, sizeof(var.alias)));
+        switch (var.type) {
+          case triton::engines::symbolic::MEMORY_VARIABLE:
+            this->load(ctx, var.origin, var.size / 8);
+            ctx->symbolizeMemory(triton::arch::MemoryAccess(var.origin, var.size / 8), alias);
+            break;
+          case triton::engines::symbolic::REGISTER_VARIABLE:
+            ctx->symbolizeRegister(ctx->getRegister(static_cast<triton::arch::register_e>(var.origin)), alias);
+            break;
+          default:
+            throw triton::exceptions::Engines("Image::restore(): Invalid variable");
+        }
+      }
+    }
+
+
+    void Image::load(triton::Context* ctx, triton::uint64 addr, triton::usize size) {
+      /* Fast path, the page has already been mapped */
+      if (ctx->isConcreteMemoryValueDefined(addr, size)) {
+        return;
+      }
+
+      const image_page_s* end = this->pages + this->header->npages;
+      for (triton::uint64 base = addr & ~(IMAGE_PAGE_SIZE - 1); base < addr + size; base += IMAGE_PAGE_SIZE) {
+        auto page = std::lower_bound(this->pages, end, base, [](const image_page_s& p, triton::uint64 a) { return p.addr < a; });
+        if (page == end || page->addr != base)
+          continue;
+        /* Runs of defined bytes are copied from the mapping */
+        triton::usize off = 0;
+        while (off < IMAGE_PAGE_SIZE) {
+          if (((page->defined[off / 8] >> (off % 8)) & 1) == 0) {
+            off++;
+            continue;
+          }
+          triton::usize last = off + 1;
+          while (last < IMAGE_PAGE_SIZE && ((page->defined[last / 8] >> (last % 8)) & 1)) {
+            last++;
+          }
+          this->fill(ctx, page->data + off, base + off, base + last);
+          off = last;
+        }
+      }
+    }
+
+
+    std::map<triton::uint64, std::string> Image::getHooks(void) const {
+      std::map<triton::uint64, std::string> ret;
+      for (triton::uint32 i = 0; i < this->header->nhooks; i++) {
+        const auto& hook = this->hooks[i];
+        ret[hook.addr] = std::string(hook.name, strnlen(hook.name, sizeof(hook.name)));
+      }
+      return ret;
+    }
+
+
+    void Image::save(const std::string& path, triton::Context* ctx, const std::map<triton::uint64, std::string>& hooks) {
+      image_header_s header{};
+      std::vector<image_reg_s> regs;
+      std::vector<image_var_s> vars;
+      std::vector<image_hook_s> hks;
+      std::map<triton::uint64, image_page_s> pages;
+
+      std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+      header.arch = ctx->getArchitecture();
+      for (triton::usize i = 0; i < sizeof(IMAGE_MODES) / sizeof(IMAGE_MODES[0]); i++) {
+        header.modes |= static_cast<triton::uint32>(ctx->isModeEnabled(IMAGE_MODES[i])) << i;
+      }
+
+      for (const auto* reg : ctx->getParentRegisters()) {
+        image_reg_s r{};
+        auto value = ctx->getConcreteRegisterValue(*reg, false);
+        r.id = reg->getId();
+        r.size = reg->getSize();
+        for (triton::uint32 i = 0; i < r.size && i < sizeof(r.value); i++) {
+          r.value[i] = static_cast<triton::uint8>((value >> (i * 8)) & 0xff);
+        }
+        regs.push_back(r);
+      }
+
+      /* Only symbolic variables are saved, other symbolic expressions would be lost */
+      triton::usize memBytes = 0;
+      triton::usize regVars = 0;
+      for (const auto& item : ctx->getSymbolicVariables()) {
+        const auto& var = item.second;
+        image_var_s v{};
+        if (item.first != vars.size()) {
+          throw triton::exceptions::Engines("Image::save(): Variable ids must be contiguous");
+        }
+        v.origin = var->getOrigin();
+        v.type = var->getType();
+        v.size = var->getSize();
+        std::strncpy(v.alias, var->getAlias().c_str(), sizeof(v.alias) - 1);
+        memBytes += (var->getType() == triton::engines::symbolic::MEMORY_VARIABLE) ? var->getSize() / 8 : 0;
+        regVars += (var->getType() == triton::engines::symbolic::REGISTER_VARIABLE);
+        vars.push_back(v);
+      }
+      if (ctx->getSymbolicMemory().size() > memBytes || ctx->getSymbolicRegisters().size() > regVars) {
+        throw triton::exceptions::Engines("Image::save(): Only symbolic variables can be saved, concretize other expressions first");
+      }
+
+      for (const auto& item : hooks) {
+        image_hook_s h{};
+        h.addr = item.first;
+        std::strncpy(h.name, item.second.c_str(), sizeof(h.name) - 1);
+        hks.push_back(h);
+      }
+
+      for (const auto& item : ctx->getCpuInstance()->getConcreteMemory()) {
+        triton::uint64 base = item.first & ~(IMAGE_PAGE_SIZE - 1);
+        triton::usize off = item.first - base;
+        auto it = pages.find(base);
+        if (it == pages.end()) {
+          it = pages.emplace(base, image_page_s{}).first;
+          it->second.addr = base;
+        }
+        it->second.defined[off / 8] |= (1 << (off % 8));
+        it->second.data[off] = item.second;
+      }
+
+      header.nregs  = regs.size();
+      header.nvars  = vars.size();
+      header.nhooks = hks.size();
+      header.npages = pages.size();
+
+      std::ofstream f(path, std::ios::binary);
+      f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      f.write(reinterpret_cast<const char*>(regs.data()), regs.size() * sizeof(image_reg_s));
+      f.write(reinterpret_cast<const char*>(vars.data()), vars.size() * sizeof(image_var_s));
+      f.write(reinterpret_cast<const char*>(hks.data()), hks.size() * sizeof(image_hook_s));
+      for (const auto& item : pages) {
+        f.write(reinterpret_cast<const char*>(&item.second), sizeof(image_page_s));
+      }
+      f.close();
+      if (f.fail()) {
+        throw triton::exceptions::Engines("Image::save(): Cannot write " + path);
+      }
+    }
+
+  };
+};
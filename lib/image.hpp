@@ -0,0 +1,150 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_IMAGE_H
+#define TRITON_IMAGE_H
+
+
+#include <map>
+#include <string>
+
+#include <triton/context.hpp>
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include <loader.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Loaders namespace
+  namespace loaders {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup loaders
+   *  @{
+   */
+
+    //! Magic of an image file.
+    const char IMAGE_MAGIC[8] = {'T', 'T', 'I', 'M', 'A', 'G', 'E', '1'};
+
+    //! Size of a page of an image.
+    const triton::usize IMAGE_PAGE_SIZE = 0x1000;
+
+    //! Header of an image.
+    struct image_header_s {
+      char           magic[8];
+      triton::uint32 arch;   /* triton::arch::architecture_e */
+      triton::uint32 modes;  /* bit i set if the i-th mode of IMAGE_MODES is enabled */
+      triton::uint32 nregs;
+      triton::uint32 nvars;
+      triton::uint32 nhooks;
+      triton::uint32 npages;
+    };
+
+    //! A register of an image.
+    struct image_reg_s {
+      triton::uint32 id;        /* triton::arch::register_e */
+      triton::uint32 size;      /* bytes */
+      triton::uint8  value[64]; /* little endian */
+    };
+
+    //! A symbolic variable of an image, in id order.
+    struct image_var_s {
+      triton::uint64 origin;    /* address or register id */
+      triton::uint32 type;      /* triton::engines::symbolic::variable_e */
+      triton::uint32 size;      /* bits */
+      char           alias[48]; /* null terminated */
+    };
+
+    //! An instruction hook of an image. The callback is bound again by name.
+    struct image_hook_s {
+      triton::uint64 addr;
+      char           name[56]; /* null terminated */
+    };
+
+    //! A page of concrete memory of an image.
+    struct image_page_s {
+      triton::uint64 addr;
+      triton::uint8  defined[IMAGE_PAGE_SIZE / 8]; /* bitmap of the defined bytes */
+      triton::uint8  data[IMAGE_PAGE_SIZE];
+    };
+
+    /*! \class Image
+        \brief Serialized initial state of a harness.
+
+        \details An image holds everything a harness prepares before the exploration: the
+        concrete memory, the registers, the modes, the symbolic variables (recreated in the
+        same order, so that seeds keep their layout) and the addresses of instruction hooks
+        with a name to bind their callback again. Other symbolic expressions are not saved.
+        Lazily mapped binaries must be populated before saving (see ElfLoader::populate()).
+
+        The file is the header followed by the arrays of registers, variables, hooks and
+        pages (sorted by address). Records are 8 bytes aligned and values are in native
+        endianness, so the file is mmaped and pages are lazily copied straight from the
+        mapping into the context, the first time they are read (see LazyLoader). Restoring
+        an image only copies the registers and the pages of memory variables. */
+    class Image : public LazyLoader {
+      private:
+        //! The file descriptor of the image.
+        int fd;
+
+        //! The mmaped image.
+        const triton::uint8* area;
+
+        //! The size of the mmaped image.
+        triton::usize areaSize;
+
+        //! The header.
+        const image_header_s* header;
+
+        //! The registers.
+        const image_reg_s* regs;
+
+        //! The symbolic variables.
+        const image_var_s* vars;
+
+        //! The hooks.
+        const image_hook_s* hooks;
+
+        //! The pages.
+        const image_page_s* pages;
+
+      public:
+        //! Constructor.
+        TRITON_EXPORT Image(const std::string& path);
+
+        //! Destructor.
+        TRITON_EXPORT ~Image();
+
+        //! Returns the architecture of the image.
+        TRITON_EXPORT triton::arch::architecture_e getArchitecture(void) const;
+
+        //! Restore the state into a context, the memory is mapped lazily. The image must outlive the context.
+        TRITON_EXPORT void restore(triton::Context* ctx);
+
+        //! Fill the pages touched by [addr, addr + size) if they are not defined yet.
+        TRITON_EXPORT void load(triton::Context* ctx, triton::uint64 addr, triton::usize size) override;
+
+        //! Returns the hooks <addr : name>.
+        TRITON_EXPORT std::map<triton::uint64, std::string> getHooks(void) const;
+
+        //! Save the state of a context and the names of its hooks <addr : name>.
+        TRITON_EXPORT static void save(const std::string& path, triton::Context* ctx, const std::map<triton::uint64, std::string>& hooks = {});
+    };
+
+  /*! @} End of loaders namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_IMAGE_H */
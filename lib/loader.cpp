@@ -0,0 +1,152 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <LIEF/ELF.hpp>
+#include <triton/exceptions.hpp>
+
+#include <loader.hpp>
+
+
+
+namespace triton {
+  namespace loaders {
+
+    LazyLoader::LazyLoader() {
+      this->backup = nullptr;
+    }
+
+
+    void LazyLoader::copy(triton::Context* ctx, const triton::uint8* src, triton::uint64 lo, triton::uint64 hi) {
+      /* Copy runs of undefined bytes, keep what has already been written */
+      triton::uint64 addr = lo;
+      while (addr < hi) {
+        if (ctx->isConcreteMemoryValueDefined(addr, 1)) {
+          addr++;
+          continue;
+        }
+        triton::uint64 end = addr + 1;
+        while (end < hi && ctx->isConcreteMemoryValueDefined(end, 1) == false) {
+          end++;
+        }
+        ctx->setConcreteMemoryAreaValue(addr, src + (addr - lo), end - addr, false);
+        addr = end;
+      }
+    }
+
+
+    void LazyLoader::fill(triton::Context* ctx, const triton::uint8* src, triton::uint64 lo, triton::uint64 hi) {
+      this->copy(ctx, src, lo, hi);
+      /* Bytes written by the program into ctx are not part of the backup, they are filled from src */
+      if (this->backup && this->backup != ctx) {
+        this->copy(this->backup, src, lo, hi);
+      }
+    }
+
+
+    void LazyLoader::map(triton::Context* ctx) {
+      ctx->addCallback(triton::callbacks::GET_CONCRETE_MEMORY_VALUE,
+        triton::ComparableFunctor<void(triton::Context&, const triton::arch::MemoryAccess&)>(
+          [this](triton::Context& ctx, const triton::arch::MemoryAccess& mem) { this->load(&ctx, mem.getAddress(), mem.getSize()); },
+          this
+        )
+      );
+    }
+
+
+    void LazyLoader::setBackup(triton::Context* ctx) {
+      this->backup = ctx;
+    }
+
+
+    ElfLoader::ElfLoader(const std::string& path) {
+      struct stat st;
+
+      this->fd = open(path.c_str(), O_RDONLY);
+      if (this->fd < 0 || fstat(this->fd, &st) != 0) {
+        throw triton::exceptions::Engines("ElfLoader::ElfLoader(): Cannot open " + path);
+      }
+
+      this->areaSize = st.st_size;
+      void* area = mmap(nullptr, this->areaSize, PROT_READ, MAP_PRIVATE, this->fd, 0);
+      if (area == MAP_FAILED) {
+        close(this->fd);
+        throw triton::exceptions::Engines("ElfLoader::ElfLoader(): Cannot mmap " + path);
+      }
+      this->area = static_cast<const triton::uint8*>(area);
+
+      /* LIEF is only used to get the segments, their content stays into the file mapping */
+      std::unique_ptr<const LIEF::ELF::Binary> binary{LIEF::ELF::Parser::parse(path)};
+      if (binary == nullptr) {
+        munmap(const_cast<triton::uint8*>(this->area), this->areaSize);
+        close(this->fd);
+        throw triton::exceptions::Engines("ElfLoader::ElfLoader(): Cannot parse " + path);
+      }
+
+      for (const LIEF::ELF::Segment& s : binary->segments()) {
+        if (s.physical_size() == 0 || s.file_offset() + s.physical_size() > this->areaSize)
+          continue;
+        segment_s seg;
+        seg.vaddr  = s.virtual_address();
+        seg.vsize  = s.virtual_size();
+        seg.offset = s.file_offset();
+        seg.fsize  = std::min<triton::uint64>(s.physical_size(), s.virtual_size());
+        this->segments.push_back(seg);
+      }
+    }
+
+
+    ElfLoader::~ElfLoader() {
+      munmap(const_cast<triton::uint8*>(this->area), this->areaSize);
+      close(this->fd);
+    }
+
+
+    void ElfLoader::load(triton::Context* ctx, triton::uint64 addr, triton::usize size) {
+      /* Fast path, the page has already been mapped */
+      if (ctx->isConcreteMemoryValueDefined(addr, size)) {
+        return;
+      }
+
+      for (triton::uint64 page = addr & ~(LAZY_PAGE_SIZE - 1); page < addr + size; page += LAZY_PAGE_SIZE) {
+        for (const auto& seg : this->segments) {
+          triton::uint64 lo = std::max<triton::uint64>(page, seg.vaddr);
+          triton::uint64 hi = std::min<triton::uint64>(page + LAZY_PAGE_SIZE, seg.vaddr + seg.fsize);
+          if (lo < hi) {
+            this->fill(ctx, this->area + seg.offset + (lo - seg.vaddr), lo, hi);
+          }
+        }
+      }
+    }
+
+
+    void ElfLoader::populate(triton::Context* ctx) {
+      for (const auto& seg : this->segments) {
+        this->fill(ctx, this->area + seg.offset, seg.vaddr, seg.vaddr + seg.fsize);
+      }
+    }
+
+
+    bool ElfLoader::isMapped(triton::uint64 addr) const {
+      for (const auto& seg : this->segments) {
+        if (addr >= seg.vaddr && addr < seg.vaddr + seg.vsize)
+          return true;
+      }
+      return false;
+    }
+
+
+    const std::vector<segment_s>& ElfLoader::getSegments(void) const {
+      return this->segments;
+    }
+
+  };
+};
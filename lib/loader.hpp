@@ -0,0 +1,127 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_LOADER_H
+#define TRITON_LOADER_H
+
+
+#include <string>
+#include <vector>
+
+#include <triton/context.hpp>
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Loaders namespace
+  namespace loaders {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup loaders
+   *  @{
+   */
+
+    //! Size of a page lazily mapped into the context.
+    const triton::usize LAZY_PAGE_SIZE = 0x1000;
+
+    //! A segment of the binary.
+    struct segment_s {
+      triton::uint64 vaddr;  /* virtual address */
+      triton::uint64 vsize;  /* size in memory */
+      triton::uint64 offset; /* offset into the file */
+      triton::uint64 fsize;  /* size into the file */
+    };
+
+    /*! \class LazyLoader
+        \brief Memory mapped lazily into a context.
+
+        \details Pages are copied into the Triton's concrete memory the first time they are
+        read (see the GET_CONCRETE_MEMORY_VALUE callback registered by map()). Only
+        undefined bytes are filled, so values written by the harness or the program are
+        kept. Pages are also filled into the backup context of the explorator (see
+        setBackup()), so that they survive the restore done after each execution and are
+        only copied once. Untouched pages are never copied. */
+    class LazyLoader {
+      protected:
+        //! The context restored after each execution, filled along with the mapped one.
+        triton::Context* backup;
+
+        //! Copy src into the undefined bytes of [lo, hi) of the context.
+        static void copy(triton::Context* ctx, const triton::uint8* src, triton::uint64 lo, triton::uint64 hi);
+
+        //! Copy src into the undefined bytes of [lo, hi) of the context and of the backup.
+        void fill(triton::Context* ctx, const triton::uint8* src, triton::uint64 lo, triton::uint64 hi);
+
+      public:
+        //! Constructor.
+        TRITON_EXPORT LazyLoader();
+
+        //! Destructor.
+        TRITON_EXPORT virtual ~LazyLoader() = default;
+
+        //! Map lazily the memory into the context.
+        TRITON_EXPORT void map(triton::Context* ctx);
+
+        //! Fill the pages touched by [addr, addr + size) if they are not defined yet.
+        TRITON_EXPORT virtual void load(triton::Context* ctx, triton::uint64 addr, triton::usize size) = 0;
+
+        //! Fill the pages faulted in from now on into this context too, nullptr to stop.
+        TRITON_EXPORT void setBackup(triton::Context* ctx);
+    };
+
+    /*! \class ElfLoader
+        \brief Lazy ELF loader.
+
+        \details The file is mmaped once and its segments are copied page by page from the
+        mapping, which is the only copy of untouched pages. */
+    class ElfLoader : public LazyLoader {
+      private:
+        //! The file descriptor of the binary.
+        int fd;
+
+        //! The mmaped binary.
+        const triton::uint8* area;
+
+        //! The size of the mmaped binary.
+        triton::usize areaSize;
+
+        //! The segments of the binary.
+        std::vector<segment_s> segments;
+
+      public:
+        //! Constructor.
+        TRITON_EXPORT ElfLoader(const std::string& path);
+
+        //! Destructor.
+        TRITON_EXPORT ~ElfLoader();
+
+        //! Fill the pages touched by [addr, addr + size) if they are not defined yet.
+        TRITON_EXPORT void load(triton::Context* ctx, triton::uint64 addr, triton::usize size) override;
+
+        //! Copy all segments into the context.
+        TRITON_EXPORT void populate(triton::Context* ctx);
+
+        //! Returns true if the address is backed by a segment of the file.
+        TRITON_EXPORT bool isMapped(triton::uint64 addr) const;
+
+        //! Returns the segments of the binary.
+        TRITON_EXPORT const std::vector<segment_s>& getSegments(void) const;
+    };
+
+  /*! @} End of loaders namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_LOADER_H */
@@ -0,0 +1,126 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <algorithm>
+
+#include <mutator.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      /* Values that often hit boundary checks (see AFL) */
+      static const triton::uint32 interestingValues[] = {
+        0x00, 0x01, 0x10, 0x20, 0x40, 0x64, 0x7f, 0x80, 0xff,
+        0x100, 0x200, 0x3e8, 0x400, 0x1000, 0x7fff, 0x8000, 0xffff,
+        0x10000, 0x7fffffff, 0x80000000, 0xfffffffe, 0xffffffff,
+      };
+
+
+      Mutator::Mutator(triton::uint64 seed)
+        : rng(seed) {
+      }
+
+
+      triton::usize Mutator::rand(triton::usize n) {
+        return (n == 0) ? 0 : (this->rng() % n);
+      }
+
+
+      triton::usize Mutator::pick(triton::usize n) {
+        return this->rand(n);
+      }
+
+
+      void Mutator::flipBit(SeedBytes& data) {
+        triton::usize bit = this->rand(data.size() * 8);
+        data[bit / 8] ^= (1 << (bit % 8));
+      }
+
+
+      void Mutator::arith(SeedBytes& data) {
+        triton::usize width = 1 << this->rand(3);
+        if (data.size() < width)
+          width = 1;
+        triton::usize offset = this->rand(data.size() - width + 1);
+        triton::uint64 delta = 1 + this->rand(35);
+        triton::uint64 value = 0;
+
+        for (triton::usize i = 0; i < width; i++) {
+          value |= static_cast<triton::uint64>(data[offset + i]) << (i * 8);
+        }
+        value = this->rand(2) ? value + delta : value - delta;
+        for (triton::usize i = 0; i < width; i++) {
+          data[offset + i] = static_cast<triton::uint8>(value >> (i * 8));
+        }
+      }
+
+
+      void Mutator::interesting(SeedBytes& data) {
+        triton::usize width = 1 << this->rand(3);
+        if (data.size() < width)
+          width = 1;
+        triton::usize offset = this->rand(data.size() - width + 1);
+        triton::uint32 value = interestingValues[this->rand(sizeof(interestingValues) / sizeof(interestingValues[0]))];
+
+        for (triton::usize i = 0; i < width; i++) {
+          data[offset + i] = static_cast<triton::uint8>(value >> (i * 8));
+        }
+      }
+
+
+      void Mutator::randomByte(SeedBytes& data) {
+        data[this->rand(data.size())] = static_cast<triton::uint8>(this->rng());
+      }
+
+
+      void Mutator::havoc(SeedBytes& data) {
+        triton::usize stack = 1 << (1 + this->rand(4));
+        for (triton::usize i = 0; i < stack; i++) {
+          switch (this->rand(4)) {
+            case 0: this->flipBit(data);     break;
+            case 1: this->arith(data);       break;
+            case 2: this->interesting(data); break;
+            case 3: this->randomByte(data);  break;
+          }
+        }
+      }
+
+
+      SeedBytes Mutator::mutate(const SeedBytes& data, const SeedBytes& other) {
+        SeedBytes ret(data);
+
+        if (ret.size() == 0)
+          return ret;
+
+        switch (this->rand(8)) {
+          /* Deterministic-like single mutations */
+          case 0: this->flipBit(ret);     break;
+          case 1: this->arith(ret);       break;
+          case 2: this->interesting(ret); break;
+
+          /* Splice with another seed and havoc */
+          case 3:
+            if (other.size() == ret.size()) {
+              triton::usize cut = this->rand(ret.size());
+              std::copy(other.begin() + cut, other.end(), ret.begin() + cut);
+            }
+            this->havoc(ret);
+            break;
+
+          default:
+            this->havoc(ret);
+            break;
+        }
+
+        return ret;
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
@@ -0,0 +1,86 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_MUTATOR_H
+#define TRITON_MUTATOR_H
+
+
+#include <random>
+
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include <seed.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      /*! \class Mutator
+          \brief Cheap mutations of seeds (bit flips, arithmetic, interesting values, havoc and splicing). */
+      class Mutator {
+        private:
+          //! The random generator.
+          std::mt19937_64 rng;
+
+          //! Returns a random number in [0, n).
+          triton::usize rand(triton::usize n);
+
+          //! Flip a random bit.
+          void flipBit(SeedBytes& data);
+
+          //! Add or sub a small value to a random byte, word or dword.
+          void arith(SeedBytes& data);
+
+          //! Write an interesting value at a random offset.
+          void interesting(SeedBytes& data);
+
+          //! Write a random byte at a random offset.
+          void randomByte(SeedBytes& data);
+
+          //! Apply a stack of random mutations.
+          void havoc(SeedBytes& data);
+
+        public:
+          //! Constructor.
+          TRITON_EXPORT Mutator(triton::uint64 seed = 0x5eed);
+
+          //! Returns a mutant of `data`. `other` is used for splicing.
+          TRITON_EXPORT SeedBytes mutate(const SeedBytes& data, const SeedBytes& other);
+
+          //! Returns a random number in [0, n).
+          TRITON_EXPORT triton::usize pick(triton::usize n);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_MUTATOR_H */
@@ -0,0 +1,809 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <triton/coreUtils.hpp>
+
+#include <presolver.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      /* Returns the value of an integer node (e.g. bounds of an extract) */
+      static triton::uint32 integer(const triton::ast::SharedAbstractNode& node) {
+        return triton::utils::cast<triton::uint32>(reinterpret_cast<triton::ast::IntegerNode*>(node.get())->getInteger());
+      }
+
+
+      /* Returns the variable of a variable node */
+      static const triton::engines::symbolic::SharedSymbolicVariable& variable(const triton::ast::SharedAbstractNode& node) {
+        return reinterpret_cast<triton::ast::VariableNode*>(node.get())->getSymbolicVariable();
+      }
+
+
+      /* Returns the unsigned comparison with swapped operands */
+      static triton::ast::ast_e mirror(triton::ast::ast_e op) {
+        switch (op) {
+          case triton::ast::BVULT_NODE: return triton::ast::BVUGT_NODE;
+          case triton::ast::BVULE_NODE: return triton::ast::BVUGE_NODE;
+          case triton::ast::BVUGT_NODE: return triton::ast::BVULT_NODE;
+          case triton::ast::BVUGE_NODE: return triton::ast::BVULE_NODE;
+          default:                      return op;
+        }
+      }
+
+
+      /* Returns the negation of a comparison */
+      static triton::ast::ast_e negate(triton::ast::ast_e op) {
+        switch (op) {
+          case triton::ast::EQUAL_NODE:    return triton::ast::DISTINCT_NODE;
+          case triton::ast::DISTINCT_NODE: return triton::ast::EQUAL_NODE;
+          case triton::ast::BVULT_NODE:    return triton::ast::BVUGE_NODE;
+          case triton::ast::BVULE_NODE:    return triton::ast::BVUGT_NODE;
+          case triton::ast::BVUGT_NODE:    return triton::ast::BVULE_NODE;
+          case triton::ast::BVUGE_NODE:    return triton::ast::BVULT_NODE;
+          default:                         return op;
+        }
+      }
+
+
+      /* Returns the value of a shift or rotation amount */
+      static triton::uint32 amount(const triton::uint512& value, triton::uint32 size) {
+        return (value >= size) ? size : triton::utils::cast<triton::uint32>(value);
+      }
+
+
+      Presolver::Presolver(triton::Context* ctx) {
+        this->ctx = ctx;
+        this->rng = 0x9e3779b97f4a7c15;
+      }
+
+
+      triton::uint64 Presolver::random(void) {
+        /* xorshift64* */
+        this->rng ^= this->rng >> 12;
+        this->rng ^= this->rng << 25;
+        this->rng ^= this->rng >> 27;
+        return this->rng * 0x2545f4914f6cdd1d;
+      }
+
+
+      const triton::ast::SharedAbstractNode& Presolver::unref(const triton::ast::SharedAbstractNode& node) {
+        const triton::ast::SharedAbstractNode* n = &node;
+        while ((*n)->getType() == triton::ast::REFERENCE_NODE) {
+          n = &reinterpret_cast<triton::ast::ReferenceNode*>(n->get())->getSymbolicExpression()->getAst();
+        }
+        return *n;
+      }
+
+
+      triton::uint512 Presolver::mask(triton::uint32 size) {
+        return (triton::uint512(1) << size) - 1;
+      }
+
+
+      void Presolver::collectVariables(const triton::ast::SharedAbstractNode& node, std::unordered_set<const triton::ast::AbstractNode*>& visited, std::set<triton::usize>& vars) {
+        std::vector<triton::ast::AbstractNode*> stack = {node.get()};
+
+        while (stack.size()) {
+          auto* n = stack.back();
+          stack.pop_back();
+          if (visited.insert(n).second == false || n->isSymbolized() == false)
+            continue;
+          switch (n->getType()) {
+            case triton::ast::VARIABLE_NODE:
+              vars.insert(reinterpret_cast<triton::ast::VariableNode*>(n)->getSymbolicVariable()->getId());
+              break;
+            case triton::ast::REFERENCE_NODE:
+              stack.push_back(reinterpret_cast<triton::ast::ReferenceNode*>(n)->getSymbolicExpression()->getAst().get());
+              break;
+            default:
+              for (const auto& child : n->getChildren()) {
+                stack.push_back(child.get());
+              }
+          }
+        }
+      }
+
+
+      bool Presolver::assignBits(const triton::engines::symbolic::SharedSymbolicVariable& var, triton::uint32 lo, triton::uint32 size, const triton::uint512& value) {
+        triton::uint512 m = this->mask(size) << lo;
+        triton::uint512 v = (value << lo) & m;
+
+        auto it = this->assigns.find(var->getId());
+        if (it == this->assigns.end()) {
+          this->assigns[var->getId()] = {var, v, m};
+          return true;
+        }
+
+        /* Bits already assigned must agree */
+        auto& assign = it->second;
+        if (((assign.value ^ v) & assign.mask & m) != 0)
+          return false;
+
+        assign.value |= v;
+        assign.mask  |= m;
+        return true;
+      }
+
+
+      bool Presolver::solveCond(const triton::ast::SharedAbstractNode& n, bool want) {
+        const auto& node = this->unref(n);
+        auto& children = node->getChildren();
+
+        switch (node->getType()) {
+          case triton::ast::LNOT_NODE:
+            return this->solveCond(children[0], !want);
+
+          case triton::ast::LAND_NODE:
+          case triton::ast::LOR_NODE: {
+            /* Only the cases where every child is forced */
+            if ((node->getType() == triton::ast::LAND_NODE) != want)
+              return false;
+            for (const auto& child : children) {
+              if (this->solveCond(child, want) == false)
+                return false;
+            }
+            return true;
+          }
+
+          case triton::ast::EQUAL_NODE:
+          case triton::ast::DISTINCT_NODE: {
+            bool eq = ((node->getType() == triton::ast::EQUAL_NODE) == want);
+            const auto* lhs = &this->unref(children[0]);
+            const auto* rhs = &this->unref(children[1]);
+
+            /* One side must be a constant */
+            if ((*lhs)->isSymbolized() == false)
+              std::swap(lhs, rhs);
+            if ((*rhs)->isSymbolized())
+              return false;
+            if ((*lhs)->isSymbolized() == false)
+              return ((*lhs)->evaluate() == (*rhs)->evaluate()) == eq;
+
+            auto k = (*rhs)->evaluate();
+
+            /* Flags are like (= (ite cond 1 0) 1), solve the condition instead */
+            if ((*lhs)->getType() == triton::ast::ITE_NODE) {
+              auto& ite = (*lhs)->getChildren();
+              if (ite[1]->isSymbolized() || ite[2]->isSymbolized())
+                return false;
+              bool then = (ite[1]->evaluate() == k);
+              bool other = (ite[2]->evaluate() == k);
+              if (then == other)
+                return false;
+              return this->solveCond(ite[0], then == eq);
+            }
+
+            /* Any other value works for a distinct, take the closest one */
+            return this->solveValue(*lhs, eq ? k : (k ^ 1));
+          }
+
+          default:
+            return false;
+        }
+      }
+
+
+      bool Presolver::solveValue(const triton::ast::SharedAbstractNode& n, triton::uint512 value) {
+        const auto& node = this->unref(n);
+        auto& children = node->getChildren();
+        triton::uint32 size = node->getBitvectorSize();
+
+        value &= this->mask(size);
+        if (node->isSymbolized() == false) {
+          return node->evaluate() == value;
+        }
+
+        switch (node->getType()) {
+          case triton::ast::VARIABLE_NODE:
+            return this->assignBits(variable(node), 0, size, value);
+
+          case triton::ast::EXTRACT_NODE: {
+            triton::uint32 hi = integer(children[0]);
+            triton::uint32 lo = integer(children[1]);
+            const auto& expr = this->unref(children[2]);
+            if (expr->getType() == triton::ast::VARIABLE_NODE) {
+              return this->assignBits(variable(expr), lo, hi - lo + 1, value);
+            }
+            /* Other bits keep their current value */
+            triton::uint512 m = this->mask(hi - lo + 1) << lo;
+            return this->solveValue(expr, (expr->evaluate() & ~m) | (value << lo));
+          }
+
+          case triton::ast::ZX_NODE: {
+            triton::uint32 xsize = size - integer(children[0]);
+            if ((value >> xsize) != 0)
+              return false;
+            return this->solveValue(children[1], value);
+          }
+
+          case triton::ast::SX_NODE: {
+            triton::uint32 xsize = size - integer(children[0]);
+            triton::uint512 low = value & this->mask(xsize);
+            triton::uint512 ext = (((low >> (xsize - 1)) & 1) != 0) ? ((this->mask(size) & ~this->mask(xsize)) | low) : low;
+            if (ext != value)
+              return false;
+            return this->solveValue(children[1], low);
+          }
+
+          case triton::ast::CONCAT_NODE: {
+            /* The first child is the most significant */
+            triton::uint32 offset = 0;
+            for (auto it = children.rbegin(); it != children.rend(); it++) {
+              triton::uint32 csize = (*it)->getBitvectorSize();
+              if (this->solveValue(*it, (value >> offset) & this->mask(csize)) == false)
+                return false;
+              offset += csize;
+            }
+            return true;
+          }
+
+          case triton::ast::BSWAP_NODE: {
+            triton::uint512 swapped = 0;
+            for (triton::uint32 i = 0; i < size / 8; i++) {
+              swapped = (swapped << 8) | ((value >> (i * 8)) & 0xff);
+            }
+            return this->solveValue(children[0], swapped);
+          }
+
+          case triton::ast::BVADD_NODE:
+            if (children[1]->isSymbolized() == false)
+              return this->solveValue(children[0], value - children[1]->evaluate());
+            if (children[0]->isSymbolized() == false)
+              return this->solveValue(children[1], value - children[0]->evaluate());
+            return false;
+
+          case triton::ast::BVSUB_NODE:
+            if (children[1]->isSymbolized() == false)
+              return this->solveValue(children[0], value + children[1]->evaluate());
+            if (children[0]->isSymbolized() == false)
+              return this->solveValue(children[1], children[0]->evaluate() - value);
+            return false;
+
+          case triton::ast::BVXOR_NODE:
+            if (children[1]->isSymbolized() == false)
+              return this->solveValue(children[0], value ^ children[1]->evaluate());
+            if (children[0]->isSymbolized() == false)
+              return this->solveValue(children[1], value ^ children[0]->evaluate());
+            return false;
+
+          case triton::ast::BVNOT_NODE:
+            return this->solveValue(children[0], ~value);
+
+          case triton::ast::BVNEG_NODE:
+            return this->solveValue(children[0], triton::uint512(0) - value);
+
+          default:
+            return false;
+        }
+      }
+
+
+      bool Presolver::inputToState(const triton::ast::SharedAbstractNode& constraint, std::unordered_map<triton::usize, triton::engines::solver::SolverModel>& model) {
+        this->assigns.clear();
+        model.clear();
+
+        if (this->solveCond(constraint, true) == false)
+          return false;
+
+        /* Bits that are not forced keep their current value */
+        for (const auto& item : this->assigns) {
+          const auto& assign = item.second;
+          auto current = this->ctx->getConcreteVariableValue(assign.var);
+          auto value = (current & ~assign.mask) | assign.value;
+          if (value != current) {
+            model[item.first] = triton::engines::solver::SolverModel(assign.var, value);
+          }
+        }
+
+        return model.size() != 0;
+      }
+
+
+      void Presolver::conjuncts(const triton::ast::SharedAbstractNode& n, std::vector<triton::ast::SharedAbstractNode>& out) {
+        const auto& node = this->unref(n);
+        if (node->getType() == triton::ast::LAND_NODE) {
+          for (const auto& child : node->getChildren()) {
+            this->conjuncts(child, out);
+          }
+          return;
+        }
+        out.push_back(node);
+      }
+
+
+      bool Presolver::collectAtoms(const triton::ast::SharedAbstractNode& n, bool want, std::vector<atom_s>& atoms) {
+        const auto& node = this->unref(n);
+        auto& children = node->getChildren();
+
+        /* Constant folding */
+        if (node->isSymbolized() == false)
+          return (node->evaluate() != 0) == want;
+
+        switch (node->getType()) {
+          case triton::ast::LNOT_NODE:
+            return this->collectAtoms(children[0], !want, atoms);
+
+          case triton::ast::LAND_NODE:
+          case triton::ast::LOR_NODE:
+            /* Only the cases where every child is implied */
+            if ((node->getType() == triton::ast::LAND_NODE) != want)
+              return true;
+            for (const auto& child : children) {
+              if (this->collectAtoms(child, want, atoms) == false)
+                return false;
+            }
+            return true;
+
+          case triton::ast::EQUAL_NODE:
+          case triton::ast::DISTINCT_NODE:
+          case triton::ast::BVULT_NODE:
+          case triton::ast::BVULE_NODE:
+          case triton::ast::BVUGT_NODE:
+          case triton::ast::BVUGE_NODE: {
+            auto op = node->getType();
+            const auto* lhs = &this->unref(children[0]);
+            const auto* rhs = &this->unref(children[1]);
+
+            /* One side must be a constant */
+            if ((*lhs)->isSymbolized() == false) {
+              std::swap(lhs, rhs);
+              op = mirror(op);
+            }
+            if ((*rhs)->isSymbolized())
+              return true;
+            if (want == false)
+              op = negate(op);
+
+            auto k = (*rhs)->evaluate();
+            bool eq = (op == triton::ast::EQUAL_NODE);
+
+            if (eq || op == triton::ast::DISTINCT_NODE) {
+              /* Flags are like (= (ite cond 1 0) 1), collect the condition instead */
+              if ((*lhs)->getType() == triton::ast::ITE_NODE) {
+                auto& ite = (*lhs)->getChildren();
+                if (ite[1]->isSymbolized() == false && ite[2]->isSymbolized() == false) {
+                  bool then = (ite[1]->evaluate() == k);
+                  bool other = (ite[2]->evaluate() == k);
+                  if (then == other)
+                    return then == eq;
+                  return this->collectAtoms(ite[0], then == eq, atoms);
+                }
+              }
+
+              /* Known bits of the operand of a mask or an extraction */
+              if (eq && (*lhs)->getType() == triton::ast::BVAND_NODE) {
+                auto& bvand = (*lhs)->getChildren();
+                for (triton::usize i = 0; i < 2; i++) {
+                  if (bvand[i]->isSymbolized() == false) {
+                    auto m = bvand[i]->evaluate();
+                    if ((k & ~m) != 0)
+                      return false;
+                    atoms.push_back({this->unref(bvand[1 - i]), triton::ast::BVAND_NODE, k, m});
+                  }
+                }
+              }
+              if (eq && (*lhs)->getType() == triton::ast::EXTRACT_NODE) {
+                auto& extract = (*lhs)->getChildren();
+                triton::uint32 lo = integer(extract[1]);
+                triton::uint32 hi = integer(extract[0]);
+                atoms.push_back({this->unref(extract[2]), triton::ast::BVAND_NODE, k << lo, this->mask(hi - lo + 1) << lo});
+              }
+            }
+
+            atoms.push_back({*lhs, op, k, 0});
+            return true;
+          }
+
+          default:
+            return true;
+        }
+      }
+
+
+      bool Presolver::refute(const std::vector<atom_s>& atoms) {
+        /* Expressions are matched by hash, and checked to be equal on collisions */
+        std::map<triton::uint512, range_s> ranges;
+
+        auto lookup = [&](const atom_s& atom) -> range_s* {
+          auto it = ranges.find(atom.node->getHash());
+          if (it == ranges.end()) {
+            auto full = atom.node->getBitvectorMask();
+            return &(ranges[atom.node->getHash()] = {atom.node, 0, full, 0, 0});
+          }
+          if (it->second.node != atom.node && it->second.node->equalTo(atom.node) == false)
+            return nullptr;
+          return &it->second;
+        };
+
+        for (const auto& atom : atoms) {
+          if (atom.op == triton::ast::DISTINCT_NODE)
+            continue;
+          auto* range = lookup(atom);
+          if (range == nullptr)
+            continue;
+          auto full = atom.node->getBitvectorMask();
+          switch (atom.op) {
+            case triton::ast::EQUAL_NODE:
+              range->lo = std::max(range->lo, atom.value);
+              range->hi = std::min(range->hi, atom.value);
+              if (((range->value ^ atom.value) & range->mask) != 0)
+                return true;
+              range->mask = full;
+              range->value = atom.value;
+              break;
+            case triton::ast::BVAND_NODE:
+              if (((range->value ^ atom.value) & range->mask & atom.mask) != 0)
+                return true;
+              range->mask |= atom.mask;
+              range->value |= atom.value & atom.mask;
+              break;
+            case triton::ast::BVULT_NODE:
+              if (atom.value == 0)
+                return true;
+              range->hi = std::min(range->hi, atom.value - 1);
+              break;
+            case triton::ast::BVULE_NODE:
+              range->hi = std::min(range->hi, atom.value);
+              break;
+            case triton::ast::BVUGT_NODE:
+              if (atom.value == full)
+                return true;
+              range->lo = std::max(range->lo, atom.value + 1);
+              break;
+            case triton::ast::BVUGE_NODE:
+              range->lo = std::max(range->lo, atom.value);
+              break;
+            default:
+              break;
+          }
+          if (range->lo > range->hi)
+            return true;
+        }
+
+        for (const auto& atom : atoms) {
+          if (atom.op != triton::ast::DISTINCT_NODE)
+            continue;
+          auto* range = lookup(atom);
+          if (range != nullptr && range->lo == atom.value && range->hi == atom.value)
+            return true;
+        }
+
+        for (const auto& item : ranges) {
+          const auto& range = item.second;
+          auto full = range.node->getBitvectorMask();
+          if (range.lo == range.hi && ((range.lo ^ range.value) & range.mask) != 0)
+            return true;
+          if (range.mask == full && (range.value < range.lo || range.value > range.hi))
+            return true;
+        }
+
+        return false;
+      }
+
+
+      bool Presolver::eval(const triton::ast::SharedAbstractNode& n, const std::unordered_map<triton::usize, triton::uint512>& values, std::unordered_map<const triton::ast::AbstractNode*, triton::uint512>& memo, triton::uint512& out) {
+        const auto* node = n.get();
+
+        /* Constant parts keep the value computed by Triton */
+        if (node->isSymbolized() == false) {
+          out = node->evaluate();
+          return true;
+        }
+
+        auto cached = memo.find(node);
+        if (cached != memo.end()) {
+          out = cached->second;
+          return true;
+        }
+
+        auto& children = n->getChildren();
+        triton::uint32 size = node->getBitvectorSize();
+        triton::uint512 full = this->mask(size);
+        triton::uint512 sign = triton::uint512(1) << (size - 1);
+        std::vector<triton::uint512> v;
+
+        switch (node->getType()) {
+          case triton::ast::VARIABLE_NODE: {
+            auto it = values.find(variable(n)->getId());
+            if (it == values.end())
+              return false;
+            out = it->second & full;
+            memo[node] = out;
+            return true;
+          }
+
+          case triton::ast::REFERENCE_NODE:
+            if (this->eval(reinterpret_cast<const triton::ast::ReferenceNode*>(node)->getSymbolicExpression()->getAst(), values, memo, out) == false)
+              return false;
+            memo[node] = out;
+            return true;
+
+          /* Integer children are parameters, not operands */
+          case triton::ast::EXTRACT_NODE:
+          case triton::ast::ZX_NODE:
+          case triton::ast::SX_NODE:
+            v.resize(children.size());
+            if (this->eval(children.back(), values, memo, v.back()) == false)
+              return false;
+            break;
+
+          default:
+            for (const auto& child : children) {
+              triton::uint512 value = 0;
+              if (child->getType() != triton::ast::INTEGER_NODE && this->eval(child, values, memo, value) == false)
+                return false;
+              v.push_back(value);
+            }
+            break;
+        }
+
+        switch (node->getType()) {
+          case triton::ast::BVADD_NODE:   out = (v[0] + v[1]) & full; break;
+          case triton::ast::BVSUB_NODE:   out = (v[0] - v[1]) & full; break;
+          case triton::ast::BVMUL_NODE:   out = (v[0] * v[1]) & full; break;
+          case triton::ast::BVAND_NODE:   out = v[0] & v[1]; break;
+          case triton::ast::BVOR_NODE:    out = v[0] | v[1]; break;
+          case triton::ast::BVXOR_NODE:   out = v[0] ^ v[1]; break;
+          case triton::ast::BVNAND_NODE:  out = ~(v[0] & v[1]) & full; break;
+          case triton::ast::BVNOR_NODE:   out = ~(v[0] | v[1]) & full; break;
+          case triton::ast::BVXNOR_NODE:  out = ~(v[0] ^ v[1]) & full; break;
+          case triton::ast::BVNOT_NODE:   out = ~v[0] & full; break;
+          case triton::ast::BVNEG_NODE:   out = (triton::uint512(0) - v[0]) & full; break;
+          case triton::ast::BVSHL_NODE:   out = (v[1] >= size) ? triton::uint512(0) : ((v[0] << amount(v[1], size)) & full); break;
+          case triton::ast::BVLSHR_NODE:  out = (v[1] >= size) ? triton::uint512(0) : (v[0] >> amount(v[1], size)); break;
+          case triton::ast::BVUDIV_NODE:  out = (v[1] == 0) ? full : (v[0] / v[1]); break;
+          case triton::ast::BVUREM_NODE:  out = (v[1] == 0) ? v[0] : (v[0] % v[1]); break;
+
+          case triton::ast::BVASHR_NODE: {
+            triton::uint32 s = amount(v[1], size);
+            bool neg = (v[0] & sign) != 0;
+            if (s >= size)
+              out = neg ? full : triton::uint512(0);
+            else
+              out = neg ? (((v[0] >> s) | ~(full >> s)) & full) : (v[0] >> s);
+            break;
+          }
+
+          case triton::ast::BVSDIV_NODE:
+          case triton::ast::BVSREM_NODE: {
+            /* Computed on magnitudes, the remainder takes the sign of the dividend */
+            bool na = (v[0] & sign) != 0;
+            bool nb = (v[1] & sign) != 0;
+            triton::uint512 a = na ? ((triton::uint512(0) - v[0]) & full) : v[0];
+            triton::uint512 b = nb ? ((triton::uint512(0) - v[1]) & full) : v[1];
+            if (b == 0)
+              return false;
+            bool neg = (node->getType() == triton::ast::BVSDIV_NODE) ? (na != nb) : na;
+            triton::uint512 r = (node->getType() == triton::ast::BVSDIV_NODE) ? (a / b) : (a % b);
+            out = neg ? ((triton::uint512(0) - r) & full) : r;
+            break;
+          }
+
+          case triton::ast::BVROL_NODE:
+          case triton::ast::BVROR_NODE: {
+            auto rot = (children[1]->getType() == triton::ast::INTEGER_NODE) ? triton::uint512(integer(children[1])) : v[1];
+            triton::uint32 r = triton::utils::cast<triton::uint32>(rot % size);
+            if (node->getType() == triton::ast::BVROR_NODE)
+              r = (size - r) % size;
+            out = (r == 0) ? v[0] : (((v[0] << r) | (v[0] >> (size - r))) & full);
+            break;
+          }
+
+          case triton::ast::BSWAP_NODE:
+            out = 0;
+            for (triton::uint32 i = 0; i < size / 8; i++) {
+              out = (out << 8) | ((v[0] >> (i * 8)) & 0xff);
+            }
+            break;
+
+          case triton::ast::CONCAT_NODE:
+            out = 0;
+            for (triton::usize i = 0; i < v.size(); i++) {
+              out = (out << children[i]->getBitvectorSize()) | v[i];
+            }
+            break;
+
+          case triton::ast::EXTRACT_NODE:
+            out = (v.back() >> integer(children[1])) & full;
+            break;
+
+          case triton::ast::ZX_NODE:
+            out = v.back();
+            break;
+
+          case triton::ast::SX_NODE: {
+            triton::uint32 xsize = size - integer(children[0]);
+            bool neg = ((v.back() >> (xsize - 1)) & 1) != 0;
+            out = neg ? ((full & ~this->mask(xsize)) | v.back()) : v.back();
+            break;
+          }
+
+          case triton::ast::ITE_NODE:       out = (v[0] != 0) ? v[1] : v[2]; break;
+          case triton::ast::EQUAL_NODE:     out = (v[0] == v[1]); break;
+          case triton::ast::DISTINCT_NODE:  out = (v[0] != v[1]); break;
+          case triton::ast::BVULT_NODE:     out = (v[0] < v[1]); break;
+          case triton::ast::BVULE_NODE:     out = (v[0] <= v[1]); break;
+          case triton::ast::BVUGT_NODE:     out = (v[0] > v[1]); break;
+          case triton::ast::BVUGE_NODE:     out = (v[0] >= v[1]); break;
+
+          /* Signed comparisons are unsigned ones with the sign bit flipped */
+          case triton::ast::BVSLT_NODE:
+          case triton::ast::BVSLE_NODE:
+          case triton::ast::BVSGT_NODE:
+          case triton::ast::BVSGE_NODE: {
+            triton::uint512 s = triton::uint512(1) << (children[0]->getBitvectorSize() - 1);
+            triton::uint512 a = v[0] ^ s;
+            triton::uint512 b = v[1] ^ s;
+            switch (node->getType()) {
+              case triton::ast::BVSLT_NODE: out = (a < b); break;
+              case triton::ast::BVSLE_NODE: out = (a <= b); break;
+              case triton::ast::BVSGT_NODE: out = (a > b); break;
+              default:                      out = (a >= b); break;
+            }
+            break;
+          }
+
+          case triton::ast::LNOT_NODE:
+            out = (v[0] == 0);
+            break;
+
+          case triton::ast::LAND_NODE:
+            out = std::all_of(v.begin(), v.end(), [](const triton::uint512& x) { return x != 0; });
+            break;
+
+          case triton::ast::LOR_NODE:
+            out = std::any_of(v.begin(), v.end(), [](const triton::uint512& x) { return x != 0; });
+            break;
+
+          case triton::ast::LXOR_NODE:
+            out = 0;
+            for (const auto& x : v) {
+              out ^= (x != 0);
+            }
+            break;
+
+          case triton::ast::IFF_NODE:
+            out = ((v[0] != 0) == (v[1] != 0));
+            break;
+
+          default:
+            return false;
+        }
+
+        memo[node] = out;
+        return true;
+      }
+
+
+      bool Presolver::holds(const std::vector<triton::ast::SharedAbstractNode>& nodes, const std::unordered_map<triton::usize, triton::uint512>& values, bool& ok) {
+        std::unordered_map<const triton::ast::AbstractNode*, triton::uint512> memo;
+        for (const auto& node : nodes) {
+          triton::uint512 value = 0;
+          if (this->eval(node, values, memo, value) == false) {
+            ok = false;
+            return false;
+          }
+          if (value == 0)
+            return false;
+        }
+        return true;
+      }
+
+
+      triton::engines::solver::status_e Presolver::presolve(const triton::ast::SharedAbstractNode& constraint, const std::function<triton::uint512(const triton::engines::symbolic::SharedSymbolicVariable&)>& base, std::unordered_map<triton::usize, triton::engines::solver::SolverModel>& model) {
+        std::vector<triton::ast::SharedAbstractNode> nodes;
+        std::vector<atom_s> atoms;
+
+        model.clear();
+        this->conjuncts(constraint, nodes);
+
+        /* Constant folding, intervals and known bits */
+        for (const auto& node : nodes) {
+          if (this->collectAtoms(node, true, atoms) == false)
+            return triton::engines::solver::UNSAT;
+        }
+        if (this->refute(atoms))
+          return triton::engines::solver::UNSAT;
+
+        /* Evaluation is only worth it on small queries */
+        std::unordered_set<const triton::ast::AbstractNode*> visited;
+        std::set<triton::usize> vars;
+        this->collectVariables(constraint, visited, vars);
+        if (visited.size() > PRESOLVE_NODES)
+          return triton::engines::solver::UNKNOWN;
+
+        std::unordered_map<triton::usize, triton::uint512> values;
+        for (const auto& id : vars) {
+          values[id] = base(this->ctx->getSymbolicVariable(id)) & this->mask(this->ctx->getSymbolicVariable(id)->getSize());
+        }
+
+        /* Conjuncts that the parent does not satisfy, usually the flipped branch */
+        std::vector<triton::ast::SharedAbstractNode> unsat;
+        for (const auto& node : nodes) {
+          bool ok = true;
+          if (this->holds({node}, values, ok) == false) {
+            if (ok == false)
+              return triton::engines::solver::UNKNOWN;
+            unsat.push_back(node);
+          }
+        }
+
+        /* Variables to change, and the constants they are compared to */
+        std::unordered_set<const triton::ast::AbstractNode*> seen;
+        std::set<triton::usize> targets;
+        std::vector<atom_s> hints;
+        for (const auto& node : unsat) {
+          this->collectVariables(node, seen, targets);
+          this->collectAtoms(node, true, hints);
+        }
+
+        std::vector<std::unordered_map<triton::usize, triton::uint512>> candidates;
+        if (unsat.empty()) {
+          candidates.push_back(values);
+        }
+
+        /* Values inverted from the constants and their neighbours */
+        for (const auto& hint : hints) {
+          if (hint.op == triton::ast::BVAND_NODE)
+            continue;
+          for (const auto& k : {hint.value, hint.value + 1, hint.value - 1}) {
+            this->assigns.clear();
+            if (this->solveValue(hint.node, k) == false || this->assigns.empty())
+              continue;
+            auto candidate = values;
+            for (const auto& item : this->assigns) {
+              auto& value = candidate[item.first];
+              value = (value & ~item.second.mask) | item.second.value;
+            }
+            candidates.push_back(std::move(candidate));
+          }
+        }
+
+        /* Random changes of a variable: small deltas, bit flips, constants and random values */
+        std::vector<triton::usize> ids(targets.begin(), targets.end());
+        for (triton::usize i = 0; ids.size() && i < PRESOLVE_TRIES; i++) {
+          auto candidate = values;
+          auto id = ids[this->random() % ids.size()];
+          auto size = this->ctx->getSymbolicVariable(id)->getSize();
+          auto& value = candidate[id];
+          switch (this->random() % 4) {
+            case 0:  value = (this->random() & 1) ? value + (this->random() % 8 + 1) : value - (this->random() % 8 + 1); break;
+            case 1:  value ^= triton::uint512(1) << (this->random() % size); break;
+            case 2:  value = hints.size() ? hints[this->random() % hints.size()].value : triton::uint512(this->random()); break;
+            default: value = triton::uint512(this->random()); break;
+          }
+          value &= this->mask(size);
+          candidates.push_back(std::move(candidate));
+        }
+
+        for (const auto& candidate : candidates) {
+          bool ok = true;
+          /* The unsatisfied conjuncts rule most candidates out, the others are checked after */
+          if (this->holds(unsat, candidate, ok) == false || this->holds(nodes, candidate, ok) == false) {
+            if (ok == false)
+              return triton::engines::solver::UNKNOWN;
+            continue;
+          }
+          for (const auto& item : candidate) {
+            model[item.first] = triton::engines::solver::SolverModel(this->ctx->getSymbolicVariable(item.first), item.second);
+          }
+          return triton::engines::solver::SAT;
+        }
+
+        return triton::engines::solver::UNKNOWN;
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
@@ -0,0 +1,160 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_PRESOLVER_H
+#define TRITON_PRESOLVER_H
+
+
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <triton/ast.hpp>
+#include <triton/context.hpp>
+#include <triton/dllexport.hpp>
+#include <triton/solverEnums.hpp>
+#include <triton/solverModel.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Number of assignments evaluated by Presolver::presolve() beyond the ones derived from constants.
+      const triton::usize PRESOLVE_TRIES = 32;
+
+      //! Queries larger than this number of nodes are not evaluated by Presolver::presolve().
+      const triton::usize PRESOLVE_NODES = 4096;
+
+      /*! \class Presolver
+          \brief Cheap solving of queries without the SMT solver.
+
+          \details The input-to-state stage recognizes comparisons between a constant and an
+          invertible transformation of input variables (identity, extraction, concatenation,
+          zero/sign extension, byte swap, add/sub/xor with a constant, not, neg). The comparison
+          is then solved by inverting the transformation, which directly gives the value of the
+          input bytes.
+
+          The presolve stage settles a whole query (a conjunction) without the solver. It is UNSAT
+          when a conjunct folds to false, or when the comparisons against constants of the same
+          expression have no common value (intervals and known bits, e.g. a flip that contradicts
+          the value of an effective address enforced earlier). It is SAT when the conjunction
+          evaluates to true under an assignment close to the parent input: values inverted from
+          the constants of the unsatisfied conjuncts, their neighbours, and random changes of
+          their variables. */
+      class Presolver {
+        private:
+          //! Assignment of the bits of a variable.
+          struct assign_s {
+            triton::engines::symbolic::SharedSymbolicVariable var;
+            triton::uint512 value;
+            triton::uint512 mask;
+          };
+
+          //! The context the constraints belong to.
+          triton::Context* ctx;
+
+          //! Comparison of an expression against a constant. BVAND_NODE stands for known bits under `mask`.
+          struct atom_s {
+            triton::ast::SharedAbstractNode node;
+            triton::ast::ast_e op;
+            triton::uint512 value;
+            triton::uint512 mask;
+          };
+
+          //! Bounds and known bits of an expression.
+          struct range_s {
+            triton::ast::SharedAbstractNode node;
+            triton::uint512 lo;
+            triton::uint512 hi;
+            triton::uint512 mask;
+            triton::uint512 value;
+          };
+
+          //! Current assignments <var id : bits>.
+          std::unordered_map<triton::usize, assign_s> assigns;
+
+          //! State of the random generator of presolve().
+          triton::uint64 rng;
+
+          //! Returns a random number.
+          triton::uint64 random(void);
+
+          //! Assign bits [lo, lo + size) of a variable. Returns false on conflict.
+          bool assignBits(const triton::engines::symbolic::SharedSymbolicVariable& var, triton::uint32 lo, triton::uint32 size, const triton::uint512& value);
+
+          //! Make a logical node evaluate to `want`.
+          bool solveCond(const triton::ast::SharedAbstractNode& node, bool want);
+
+          //! Make a bitvector node evaluate to `value`.
+          bool solveValue(const triton::ast::SharedAbstractNode& node, triton::uint512 value);
+
+          //! Split a conjunction.
+          void conjuncts(const triton::ast::SharedAbstractNode& node, std::vector<triton::ast::SharedAbstractNode>& out);
+
+          //! Collect the comparisons against constants implied by a logical node being `want`. Returns false if it folds to the opposite.
+          bool collectAtoms(const triton::ast::SharedAbstractNode& node, bool want, std::vector<atom_s>& atoms);
+
+          //! Returns true if comparisons have no common solution.
+          bool refute(const std::vector<atom_s>& atoms);
+
+          //! Evaluate a node under an assignment of the variables. Returns false on unsupported nodes.
+          bool eval(const triton::ast::SharedAbstractNode& node, const std::unordered_map<triton::usize, triton::uint512>& values, std::unordered_map<const triton::ast::AbstractNode*, triton::uint512>& memo, triton::uint512& out);
+
+          //! Returns true if every node evaluates to true under an assignment.
+          bool holds(const std::vector<triton::ast::SharedAbstractNode>& nodes, const std::unordered_map<triton::usize, triton::uint512>& values, bool& ok);
+
+        public:
+          //! Constructor.
+          TRITON_EXPORT Presolver(triton::Context* ctx);
+
+          //! Solve a comparison constraint by inverting the input-to-state mapping. The model only contains variables whose value changes.
+          TRITON_EXPORT bool inputToState(const triton::ast::SharedAbstractNode& constraint, std::unordered_map<triton::usize, triton::engines::solver::SolverModel>& model);
+
+          //! Settle a query with cheap checks. `base` gives the value of variables in the parent input. Returns SAT (with a model), UNSAT, or UNKNOWN if the solver is needed.
+          TRITON_EXPORT triton::engines::solver::status_e presolve(const triton::ast::SharedAbstractNode& constraint, const std::function<triton::uint512(const triton::engines::symbolic::SharedSymbolicVariable&)>& base, std::unordered_map<triton::usize, triton::engines::solver::SolverModel>& model);
+
+          //! Returns the node behind references.
+          TRITON_EXPORT static const triton::ast::SharedAbstractNode& unref(const triton::ast::SharedAbstractNode& node);
+
+          //! Collect the ids of the variables of a node. Nodes already visited are skipped.
+          TRITON_EXPORT static void collectVariables(const triton::ast::SharedAbstractNode& node, std::unordered_set<const triton::ast::AbstractNode*>& visited, std::set<triton::usize>& vars);
+
+          //! Returns a mask of `size` bits.
+          TRITON_EXPORT static triton::uint512 mask(triton::uint32 size);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_PRESOLVER_H */
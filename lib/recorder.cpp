@@ -0,0 +1,123 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <cstring>
+#include <sstream>
+#include <unordered_set>
+#include <vector>
+
+#include <triton/exceptions.hpp>
+#include <triton/symbolicExpression.hpp>
+#include <triton/symbolicVariable.hpp>
+
+#include <recorder.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      /* Returns the SMT sort of a node */
+      static std::string sort(const triton::ast::SharedAbstractNode& node) {
+        if (node->isLogical())
+          return "Bool";
+        return "(_ BitVec " + std::to_string(node->getBitvectorSize()) + ")";
+      }
+
+
+      void QueryRecorder::open(const std::string& path) {
+        this->file.open(path, std::ios::binary | std::ios::trunc);
+        if (this->file.fail()) {
+          throw triton::exceptions::Engines("QueryRecorder::open(): Cannot open " + path);
+        }
+        this->file.write(QUERY_MAGIC, sizeof(QUERY_MAGIC));
+      }
+
+
+      bool QueryRecorder::isOpen(void) const {
+        return this->file.is_open();
+      }
+
+
+      std::string QueryRecorder::toSmt(const triton::ast::SharedAbstractNode& node) {
+        std::unordered_set<const triton::ast::AbstractNode*> visited;
+        std::vector<triton::engines::symbolic::SharedSymbolicVariable> vars;
+        std::vector<triton::engines::symbolic::SharedSymbolicExpression> refs;
+
+        /* Post-order walk, so that a reference is defined after the ones it uses */
+        std::vector<std::pair<triton::ast::AbstractNode*, bool>> stack = {{node.get(), false}};
+        while (stack.size()) {
+          auto [n, done] = stack.back();
+          stack.pop_back();
+          if (done) {
+            refs.push_back(reinterpret_cast<triton::ast::ReferenceNode*>(n)->getSymbolicExpression());
+            continue;
+          }
+          if (visited.insert(n).second == false)
+            continue;
+          switch (n->getType()) {
+            case triton::ast::VARIABLE_NODE:
+              vars.push_back(reinterpret_cast<triton::ast::VariableNode*>(n)->getSymbolicVariable());
+              break;
+            case triton::ast::REFERENCE_NODE:
+              stack.push_back({n, true});
+              stack.push_back({reinterpret_cast<triton::ast::ReferenceNode*>(n)->getSymbolicExpression()->getAst().get(), false});
+              break;
+            default:
+              for (const auto& child : n->getChildren()) {
+                stack.push_back({child.get(), false});
+              }
+          }
+        }
+
+        std::stringstream ss;
+        for (const auto& var : vars) {
+          const auto& name = var->getAlias().empty() ? var->getName() : var->getAlias();
+          ss << "(declare-fun " << name << " () (_ BitVec " << var->getSize() << "))" << std::endl;
+        }
+        for (const auto& expr : refs) {
+          ss << "(define-fun " << expr->getFormattedId() << " () " << sort(expr->getAst()) << " " << expr->getAst() << ")" << std::endl;
+        }
+        ss << "(assert " << node << ")" << std::endl;
+        ss << "(check-sat)" << std::endl;
+
+        return ss.str();
+      }
+
+
+      void QueryRecorder::record(const triton::ast::SharedAbstractNode& node, const record_s& header) {
+        auto smt = this->toSmt(node);
+        record_s h = header;
+        h.length = static_cast<triton::uint32>(smt.size());
+        this->file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        this->file.write(smt.data(), smt.size());
+        this->file.flush();
+      }
+
+
+      bool QueryRecorder::readMagic(std::istream& in) {
+        char magic[sizeof(QUERY_MAGIC)];
+        in.read(magic, sizeof(magic));
+        return in.good() && std::memcmp(magic, QUERY_MAGIC, sizeof(magic)) == 0;
+      }
+
+
+      bool QueryRecorder::read(std::istream& in, record_s& header, std::string& smt) {
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (in.gcount() != sizeof(header))
+          return false;
+        smt.resize(header.length);
+        in.read(&smt[0], header.length);
+        if (static_cast<triton::uint32>(in.gcount()) != header.length) {
+          throw triton::exceptions::Engines("QueryRecorder::read(): Truncated record");
+        }
+        return true;
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
@@ -0,0 +1,97 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_RECORDER_H
+#define TRITON_RECORDER_H
+
+
+#include <fstream>
+#include <istream>
+#include <string>
+
+#include <triton/ast.hpp>
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Magic of a query file.
+      const char QUERY_MAGIC[4] = {'T', 'T', 'Q', '1'};
+
+      //! Header of a recorded query, followed by `length` bytes of SMT-LIB2.
+      struct record_s {
+        triton::uint8  origin;  /* origin_e of the query */
+        triton::uint8  status;  /* status_e returned by the solver */
+        triton::uint16 limit;   /* number of models asked, saturated */
+        triton::uint32 timeout; /* seconds */
+        triton::uint64 addr;    /* source address of the query */
+        triton::uint32 latency; /* milliseconds */
+        triton::uint32 length;  /* size of the SMT-LIB2 script */
+      };
+
+      /*! \class QueryRecorder
+          \brief Append-only recording of solver queries.
+
+          \details The file starts with QUERY_MAGIC and is a sequence of a record_s followed
+          by a self-contained SMT-LIB2 script (declarations of the variables, definitions
+          of the references in dependency order, the assertion and `(check-sat)`). Records
+          are written in native endianness. */
+      class QueryRecorder {
+        private:
+          //! The output file.
+          std::ofstream file;
+
+        public:
+          //! Open the file, truncated.
+          TRITON_EXPORT void open(const std::string& path);
+
+          //! Returns true if the file is open.
+          TRITON_EXPORT bool isOpen(void) const;
+
+          //! Append a query.
+          TRITON_EXPORT void record(const triton::ast::SharedAbstractNode& node, const record_s& header);
+
+          //! Returns the SMT-LIB2 script of a constraint.
+          TRITON_EXPORT static std::string toSmt(const triton::ast::SharedAbstractNode& node);
+
+          //! Read the magic of a query file. Returns false if it is not a query file.
+          TRITON_EXPORT static bool readMagic(std::istream& in);
+
+          //! Read the next query. Returns false at the end of the file.
+          TRITON_EXPORT static bool read(std::istream& in, record_s& header, std::string& smt);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_RECORDER_H */
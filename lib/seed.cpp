@@ -0,0 +1,73 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <seed.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      Seed::Seed() {
+      }
+
+
+      Seed::Seed(SeedBytes bytes) {
+        this->base = std::make_shared<const SeedBytes>(std::move(bytes));
+      }
+
+
+      Seed::Seed(const std::shared_ptr<const SeedBytes>& base, std::vector<SeedPatch> patches)
+        : base(base), patches(std::move(patches)) {
+      }
+
+
+      SeedBytes Seed::bytes(void) const {
+        SeedBytes ret;
+        this->materialize(ret);
+        return ret;
+      }
+
+
+      void Seed::materialize(SeedBytes& dst) const {
+        if (this->base == nullptr) {
+          dst.clear();
+          return;
+        }
+        dst = *this->base;
+        for (const auto& patch : this->patches) {
+          dst[patch.first] = patch.second;
+        }
+      }
+
+
+      triton::usize Seed::size(void) const {
+        return (this->base == nullptr) ? 0 : this->base->size();
+      }
+
+
+      triton::usize Seed::footprint(void) const {
+        triton::usize ret = sizeof(Seed) + this->patches.size() * sizeof(SeedPatch);
+        if (this->isDiff() == false && this->base != nullptr) {
+          ret += this->base->size();
+        }
+        return ret;
+      }
+
+
+      const SeedBytes* Seed::parent(void) const {
+        return this->isDiff() ? this->base.get() : nullptr;
+      }
+
+
+      bool Seed::isDiff(void) const {
+        return this->patches.size() != 0;
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
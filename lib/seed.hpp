@@ -0,0 +1,100 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_SEED_H
+#define TRITON_SEED_H
+
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Shortcut for the bytes of a seed.
+      using SeedBytes = std::vector<triton::uint8>;
+
+      //! Shortcut for a sparse patch <offset : byte>.
+      using SeedPatch = std::pair<triton::uint32, triton::uint8>;
+
+      /*! \class Seed
+          \brief A compact seed.
+
+          \details The seed is a contiguous byte buffer indexed by the layout of symbolic
+          variables (see `SymbolicExplorator::initLayout`). A seed is either stored flat
+          or as a sparse list of patches applied on top of its parent's bytes, which are
+          shared between all siblings. */
+      class Seed {
+        private:
+          //! Bytes of the parent (or the seed itself when there is no patch).
+          std::shared_ptr<const SeedBytes> base;
+
+          //! Patches applied on top of the base, sorted by offset.
+          std::vector<SeedPatch> patches;
+
+        public:
+          //! Constructor of an empty seed.
+          TRITON_EXPORT Seed();
+
+          //! Constructor of a flat seed.
+          TRITON_EXPORT Seed(SeedBytes bytes);
+
+          //! Constructor of a seed stored as a diff against its parent.
+          TRITON_EXPORT Seed(const std::shared_ptr<const SeedBytes>& base, std::vector<SeedPatch> patches);
+
+          //! Returns the flat bytes of the seed.
+          TRITON_EXPORT SeedBytes bytes(void) const;
+
+          //! Writes the flat bytes of the seed into dst.
+          TRITON_EXPORT void materialize(SeedBytes& dst) const;
+
+          //! Returns the number of bytes of the seed.
+          TRITON_EXPORT triton::usize size(void) const;
+
+          //! Returns the number of bytes owned by this seed (shared base excluded).
+          TRITON_EXPORT triton::usize footprint(void) const;
+
+          //! Returns the bytes of the parent shared with the siblings, nullptr if the seed is flat.
+          TRITON_EXPORT const SeedBytes* parent(void) const;
+
+          //! Returns true if the seed is stored as a diff against its parent.
+          TRITON_EXPORT bool isDiff(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_SEED_H */
@@ -0,0 +1,98 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <cstdio>
+
+#include <triton/exceptions.hpp>
+
+#include <timeline.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      CoverageTimeline::CoverageTimeline() {
+        this->drcovCount = 0;
+        this->nbbs = 0;
+      }
+
+
+      triton::uint32 CoverageTimeline::elapsed(void) const {
+        return static_cast<triton::uint32>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->start).count());
+      }
+
+
+      void CoverageTimeline::open(const std::string& dir) {
+        this->events.open(dir + "/timeline.bin", std::ios::binary | std::ios::trunc);
+        this->addresses.open(dir + "/addresses.txt", std::ios::trunc);
+        this->drcov.open(dir + "/coverage.drcov", std::ios::binary | std::ios::trunc);
+        if (this->isOpen() == false) {
+          throw triton::exceptions::Engines("CoverageTimeline::open(): Cannot create the coverage files into " + dir);
+        }
+
+        this->drcov << "DRCOV VERSION: 2\n"
+                    << "DRCOV FLAVOR: drcov\n"
+                    << "Module Table: version 2, count 1\n"
+                    << "Columns: id, base, end, entry, checksum, timestamp, path\n"
+                    << " 0, 0x0000000000000000, 0x00000000ffffffff, 0x0000000000000000, 0x00000000, 0x00000000, target\n"
+                    << "BB Table: ";
+        this->drcovCount = this->drcov.tellp();
+        this->drcov << "0000000000 bbs\n";
+
+        this->nbbs = 0;
+        this->start = std::chrono::steady_clock::now();
+      }
+
+
+      bool CoverageTimeline::isOpen(void) const {
+        return this->events.is_open() && this->addresses.is_open() && this->drcov.is_open();
+      }
+
+
+      void CoverageTimeline::addInstruction(triton::uint64 addr, triton::uint32 size, triton::usize exec) {
+        timeline_event_s event = {addr, 0, static_cast<triton::uint32>(exec), this->elapsed()};
+        this->events.write(reinterpret_cast<const char*>(&event), sizeof(event));
+        this->addresses << "0x" << std::hex << addr << std::dec << "\n";
+
+        /* drcov blocks are <u32 offset, u16 size, u16 module id> */
+        if (addr <= 0xffffffff) {
+          triton::uint32 offset = static_cast<triton::uint32>(addr);
+          triton::uint16 bbsize = static_cast<triton::uint16>(size);
+          triton::uint16 module = 0;
+          this->drcov.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+          this->drcov.write(reinterpret_cast<const char*>(&bbsize), sizeof(bbsize));
+          this->drcov.write(reinterpret_cast<const char*>(&module), sizeof(module));
+          this->nbbs++;
+        }
+      }
+
+
+      void CoverageTimeline::addEdge(triton::uint64 src, triton::uint64 dst, triton::usize exec) {
+        timeline_event_s event = {src, dst, static_cast<triton::uint32>(exec), this->elapsed()};
+        this->events.write(reinterpret_cast<const char*>(&event), sizeof(event));
+      }
+
+
+      void CoverageTimeline::flush(void) {
+        char count[11];
+
+        /* Patch the number of blocks in place, the header keeps its size */
+        std::snprintf(count, sizeof(count), "%010u", this->nbbs);
+        auto end = this->drcov.tellp();
+        this->drcov.seekp(this->drcovCount);
+        this->drcov.write(count, 10);
+        this->drcov.seekp(end);
+
+        this->events.flush();
+        this->addresses.flush();
+        this->drcov.flush();
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
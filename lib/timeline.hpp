@@ -0,0 +1,110 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_TIMELINE_H
+#define TRITON_TIMELINE_H
+
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! An event of the coverage timeline. Instructions have a null `dst`.
+      struct timeline_event_s {
+        triton::uint64 src;  /* address of the instruction or source of the edge */
+        triton::uint64 dst;  /* destination of the edge */
+        triton::uint32 exec; /* execution number */
+        triton::uint32 ms;   /* milliseconds since the start of the exploration */
+      };
+
+      /*! \class CoverageTimeline
+          \brief Streaming log and exports of the coverage.
+
+          \details New instructions and edges are appended as they are discovered, so that
+          a run can be watched in progress and compared to others. Three files are written:
+          `timeline.bin` (timeline_event_s records, native endianness), `addresses.txt`
+          (one address per line) and `coverage.drcov` (drcov v2 with a single module based
+          at 0, so that addresses above 4 GB are not exported). The number of blocks of the
+          drcov header has a fixed width and is patched when streams are flushed. */
+      class CoverageTimeline {
+        private:
+          //! Coverage events.
+          std::ofstream events;
+
+          //! Address list.
+          std::ofstream addresses;
+
+          //! drcov export.
+          std::ofstream drcov;
+
+          //! Offset of the number of blocks in the drcov header.
+          std::streamoff drcovCount;
+
+          //! Number of blocks in the drcov export.
+          triton::uint32 nbbs;
+
+          //! Start of the exploration.
+          std::chrono::steady_clock::time_point start;
+
+          //! Milliseconds since the start.
+          triton::uint32 elapsed(void) const;
+
+        public:
+          //! Constructor.
+          TRITON_EXPORT CoverageTimeline();
+
+          //! Create the files into a directory.
+          TRITON_EXPORT void open(const std::string& dir);
+
+          //! Returns true if files are open.
+          TRITON_EXPORT bool isOpen(void) const;
+
+          //! Log a new instruction.
+          TRITON_EXPORT void addInstruction(triton::uint64 addr, triton::uint32 size, triton::usize exec);
+
+          //! Log a new edge.
+          TRITON_EXPORT void addEdge(triton::uint64 src, triton::uint64 dst, triton::usize exec);
+
+          //! Flush the files, typically after each execution.
+          TRITON_EXPORT void flush(void);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_TIMELINE_H */
@@ -0,0 +1,130 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <triton/exceptions.hpp>
+
+#include <trace.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      TraceRecorder::TraceRecorder() {
+        this->setSize(TRACE_CHUNK_SIZE);
+      }
+
+
+      void TraceRecorder::setSize(triton::usize size) {
+        this->ring.assign(std::max<triton::usize>(1, size / TRACE_CHUNK_SIZE), trace_chunk_s());
+        for (auto& chunk : this->ring) {
+          chunk.data.reserve(TRACE_CHUNK_SIZE);
+        }
+        this->reset();
+      }
+
+
+      void TraceRecorder::reset(void) {
+        for (auto& chunk : this->ring) {
+          chunk.base = 0;
+          chunk.count = 0;
+          chunk.data.clear();
+        }
+        this->head = 0;
+        this->used = 1;
+        this->last = 0;
+        this->total = 0;
+      }
+
+
+      void TraceRecorder::nextChunk(void) {
+        this->head = (this->head + 1) % this->ring.size();
+        this->used = std::min(this->used + 1, this->ring.size());
+        auto& chunk = this->ring[this->head];
+        chunk.base = this->last;
+        chunk.count = 0;
+        chunk.data.clear();
+      }
+
+
+      void TraceRecorder::flush(const std::string& path) const {
+        std::ofstream f(path, std::ios::binary);
+        triton::uint32 n = static_cast<triton::uint32>(this->used);
+
+        f.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        f.write(reinterpret_cast<const char*>(&this->total), sizeof(this->total));
+        f.write(reinterpret_cast<const char*>(&n), sizeof(n));
+
+        /* From the oldest chunk to the one being written */
+        for (triton::usize i = 0; i < this->used; i++) {
+          const auto& chunk = this->ring[(this->head + this->ring.size() - this->used + 1 + i) % this->ring.size()];
+          triton::uint32 size = static_cast<triton::uint32>(chunk.data.size());
+          f.write(reinterpret_cast<const char*>(&chunk.base), sizeof(chunk.base));
+          f.write(reinterpret_cast<const char*>(&chunk.count), sizeof(chunk.count));
+          f.write(reinterpret_cast<const char*>(&size), sizeof(size));
+          f.write(reinterpret_cast<const char*>(chunk.data.data()), size);
+        }
+
+        f.close();
+        if (f.fail()) {
+          throw triton::exceptions::Engines("TraceRecorder::flush(): Cannot write " + path);
+        }
+      }
+
+
+      bool TraceRecorder::decode(std::istream& in, std::vector<trace_entry_s>& entries, triton::uint64& total) {
+        char magic[sizeof(TRACE_MAGIC)];
+        triton::uint32 n = 0;
+
+        in.read(magic, sizeof(magic));
+        if (in.fail() || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0)
+          return false;
+        in.read(reinterpret_cast<char*>(&total), sizeof(total));
+        in.read(reinterpret_cast<char*>(&n), sizeof(n));
+
+        for (triton::uint32 i = 0; i < n; i++) {
+          triton::uint64 pc = 0;
+          triton::uint32 count = 0;
+          triton::uint32 size = 0;
+          in.read(reinterpret_cast<char*>(&pc), sizeof(pc));
+          in.read(reinterpret_cast<char*>(&count), sizeof(count));
+          in.read(reinterpret_cast<char*>(&size), sizeof(size));
+          std::vector<triton::uint8> data(size);
+          in.read(reinterpret_cast<char*>(data.data()), size);
+          if (in.fail()) {
+            throw triton::exceptions::Engines("TraceRecorder::decode(): Truncated trace");
+          }
+
+          triton::usize off = 0;
+          for (triton::uint32 j = 0; j < count; j++) {
+            if (off >= data.size()) {
+              throw triton::exceptions::Engines("TraceRecorder::decode(): Truncated chunk");
+            }
+            /* The first byte holds taken and the 6 low bits of the zigzag delta */
+            triton::uint8 byte = data[off++];
+            bool taken = byte & 1;
+            triton::uint64 z = (byte >> 1) & 0x3f;
+            for (triton::uint32 shift = 6; (byte & 0x80) && off < data.size(); shift += 7) {
+              byte = data[off++];
+              z |= static_cast<triton::uint64>(byte & 0x7f) << shift;
+            }
+            triton::sint64 delta = static_cast<triton::sint64>(z >> 1) ^ -static_cast<triton::sint64>(z & 1);
+            pc += delta;
+            entries.push_back({pc, taken});
+          }
+        }
+
+        return true;
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
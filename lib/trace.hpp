@@ -0,0 +1,145 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_TRACE_H
+#define TRITON_TRACE_H
+
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <triton/dllexport.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Magic of a trace file.
+      const char TRACE_MAGIC[4] = {'T', 'T', 'T', '1'};
+
+      //! Size of a chunk of the ring (bytes).
+      const triton::usize TRACE_CHUNK_SIZE = 0x1000;
+
+      //! A chunk of the trace. The first pc is absolute, the next ones are deltas.
+      struct trace_chunk_s {
+        triton::uint64 base;             /* pc preceding the first entry */
+        triton::uint32 count;            /* number of entries */
+        std::vector<triton::uint8> data; /* varints */
+      };
+
+      //! A decoded entry of a trace.
+      struct trace_entry_s {
+        triton::uint64 pc;
+        bool taken; /* the instruction is a branch and it has been taken */
+      };
+
+      /*! \class TraceRecorder
+          \brief Low-overhead recording of the executed instructions.
+
+          \details Each instruction is encoded as a 65-bit varint of `(zigzag(pc - previous pc) << 1) | taken`
+          (at most 10 bytes), most of them take one byte. Varints are appended to fixed size chunks organized as a
+          ring, so that the memory is bounded and the last instructions of a long execution
+          are kept. Each chunk starts from an absolute pc and can be decoded on its own.
+
+          File format: TRACE_MAGIC, the number of instructions executed (u64), the number of
+          chunks (u32), then for each chunk from the oldest: base (u64), count (u32), size (u32)
+          and the varints. Values are written in native endianness. */
+      class TraceRecorder {
+        private:
+          //! The ring of chunks.
+          std::vector<trace_chunk_s> ring;
+
+          //! Index of the chunk being written.
+          triton::usize head;
+
+          //! Number of chunks used since the reset.
+          triton::usize used;
+
+          //! The last pc recorded.
+          triton::uint64 last;
+
+          //! Number of instructions recorded since the reset.
+          triton::uint64 total;
+
+          //! Start a new chunk, overwriting the oldest one when the ring is full.
+          void nextChunk(void);
+
+        public:
+          //! Constructor.
+          TRITON_EXPORT TraceRecorder();
+
+          //! Set the memory of the ring (bytes).
+          TRITON_EXPORT void setSize(triton::usize size);
+
+          //! Clear the trace before an execution.
+          TRITON_EXPORT void reset(void);
+
+          //! Record an executed instruction.
+          inline void record(triton::uint64 pc, bool taken) {
+            auto& chunk = this->ring[this->head];
+            if (chunk.data.size() + 10 > TRACE_CHUNK_SIZE) {
+              this->nextChunk();
+              return this->record(pc, taken);
+            }
+            triton::sint64 delta = static_cast<triton::sint64>(pc - this->last);
+            triton::uint64 z = (static_cast<triton::uint64>(delta) << 1) ^ static_cast<triton::uint64>(delta >> 63);
+            /* 65 bits: the first byte holds taken and 6 bits of z, so that no bit of z is shifted out */
+            triton::uint8 first = static_cast<triton::uint8>(((z & 0x3f) << 1) | taken);
+            z >>= 6;
+            if (z == 0) {
+              chunk.data.push_back(first);
+            }
+            else {
+              chunk.data.push_back(first | 0x80);
+              while (z >= 0x80) {
+                chunk.data.push_back(static_cast<triton::uint8>(z | 0x80));
+                z >>= 7;
+              }
+              chunk.data.push_back(static_cast<triton::uint8>(z));
+            }
+            chunk.count++;
+            this->last = pc;
+            this->total++;
+          }
+
+          //! Write the trace into a file.
+          TRITON_EXPORT void flush(const std::string& path) const;
+
+          //! Decode a trace file. Returns false if it is not a trace file.
+          TRITON_EXPORT static bool decode(std::istream& in, std::vector<trace_entry_s>& entries, triton::uint64& total);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_TRACE_H */
@@ -4,11 +4,15 @@
 **  Jonathan Salwan
 */
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include <triton/aarch64Cpu.hpp>
@@ -18,6 +22,7 @@
 #include <triton/x8664Cpu.hpp>
 #include <triton/x86Cpu.hpp>
 
+#include <presolver.hpp>
 #include <ttexplore.hpp>
 
 
@@ -26,20 +31,121 @@ namespace triton {
   namespace engines {
     namespace exploration {
 
+      /*
+       * Per-architecture traits. The hot paths of the explorator (the run loop, the
+       * program counter access, the snapshot copy and the routine return) are templated
+       * on them, so that the architecture is resolved once per call instead of at
+       * each instruction.
+       */
+      struct x86_s {
+        using Cpu = triton::arch::x86::x86Cpu;
+        static const triton::arch::Register& pc(triton::Context* ctx) { return ctx->registers.x86_eip; }
+        static triton::arch::Instruction ret(triton::Context*) { return triton::arch::Instruction("\xc3", 1); }
+      };
+
+      struct x8664_s {
+        using Cpu = triton::arch::x86::x8664Cpu;
+        static const triton::arch::Register& pc(triton::Context* ctx) { return ctx->registers.x86_rip; }
+        static triton::arch::Instruction ret(triton::Context*) { return triton::arch::Instruction("\xc3", 1); }
+      };
+
+      struct arm32_s {
+        using Cpu = triton::arch::arm::arm32::Arm32Cpu;
+        static const triton::arch::Register& pc(triton::Context* ctx) { return ctx->registers.arm32_pc; }
+        static triton::arch::Instruction ret(triton::Context* ctx) {
+          /* bx lr */
+          if (static_cast<Cpu*>(ctx->getCpuInstance())->isThumb())
+            return triton::arch::Instruction("\x70\x47", 2);
+          return triton::arch::Instruction("\x1e\xff\x2f\xe1", 4);
+        }
+      };
+
+      struct aarch64_s {
+        using Cpu = triton::arch::arm::aarch64::AArch64Cpu;
+        static const triton::arch::Register& pc(triton::Context* ctx) { return ctx->registers.aarch64_pc; }
+        static triton::arch::Instruction ret(triton::Context*) { return triton::arch::Instruction("\xc0\x03\x5f\xd6", 4); }
+      };
+
+
+      /* Watchdog: number of executions sampled, limits before enough samples, and lower bounds */
+      const triton::usize WATCHDOG_SAMPLES  = 1024;
+      const triton::usize WATCHDOG_WARMUP   = 16;
+      const triton::usize WATCHDOG_INST     = 1000000;
+      const triton::usize WATCHDOG_TIME     = 10000;
+      const triton::usize WATCHDOG_MIN_INST = 10000;
+      const triton::usize WATCHDOG_MIN_TIME = 1000;
+
+      /* Jump targets are bound to variables whose ids are outside of the context */
+      const triton::usize JMP_VARIABLE_BASE = static_cast<triton::usize>(1) << 48;
+
+      /* Nodes walked to decide if an effective address is implied by earlier pins */
+      const triton::usize PIN_IMPLIED_NODES = 256;
+
+
+      /* FNV-1a step over a 64-bit value */
+      static inline triton::uint64 hash64(triton::uint64 h, triton::uint64 v) {
+        for (triton::usize i = 0; i < 8; i++) {
+          h = (h ^ ((v >> (i * 8)) & 0xff)) * 0x100000001b3;
+        }
+        return h;
+      }
+
+
       SymbolicExplorator::SymbolicExplorator() {
+        this->config.crash_trail = 8;
+        this->config.deprioritize_covered = false;
         this->config.ea_model = 1000;
+        this->config.hang_factor = 10;
+        this->config.hang_inst = 0;
+        this->config.hang_time = 0;
+        this->config.input_to_state = true;
         this->config.jmp_model = 1000;
+        this->config.lazy_solving = false;
         this->config.limit_inst = 0;
+        this->config.mutation = false;
+        this->config.mutation_rounds = 1000;
+        this->config.mutation_timeouts = 16;
+        this->config.presolve = true;
+        this->config.model_hints = false;
+        this->config.skip_covered = COVER_NONE;
+        this->config.record_queries = false;
+        this->config.solver_profile = false;
         this->config.stats = true;
+        this->config.taint_prepass = false;
         this->config.timeout = 60;
+        this->config.coverage_timeline = false;
+        this->config.trace = false;
+        this->config.trace_size = 1024;
         this->config.end_point = 0;
+        this->config.worklist_budget = 0;
 
         this->bck_ctx = nullptr;
         this->ini_ctx = nullptr;
+        this->loader = nullptr;
+        this->execSamples = 0;
+        this->layoutSize = 0;
+        this->pathHash = 0;
+        this->runPriority = 0;
+        this->mode = MODE_SYMBOLIC;
+        this->nbcrash = 0;
+        this->nbdeprio = 0;
         this->nbexec = 0;
+        this->nbhang = 0;
+        this->nbi2s = 0;
+        this->nbjmpvar = 0;
+        this->nbmutant = 0;
+        this->nbmutcov = 0;
+        this->nbpresolve = 0;
+        this->nbhint = 0;
+        this->nbdup = 0;
         this->nbsat = 0;
+        this->nbskip = 0;
         this->nbtimeout = 0;
         this->nbunsat = 0;
+        this->solverTime = 0;
+        this->taintHit = false;
+        this->watchdogInst = WATCHDOG_INST;
+        this->watchdogTime = WATCHDOG_TIME;
       }
 
 
@@ -60,18 +166,72 @@ namespace triton {
       }
 
 
+      void SymbolicExplorator::initLoader(triton::loaders::LazyLoader* loader) {
+        this->loader = loader;
+        this->cfg.setLoader(loader);
+      }
+
+
+      void SymbolicExplorator::initState(void) {
+        /* Memory hooks are dispatched by the callbacks of the initial context */
+        this->hooks.attach(this->ini_ctx);
+
+        /* Alocate and init a backup context */
+        this->bck_ctx = new triton::Context(this->ini_ctx->getArchitecture());
+        this->snapshotContext(this->bck_ctx, this->ini_ctx);
+
+        /* Pages lazily mapped during executions are kept by the backup context */
+        if (this->loader) {
+          this->loader->setBackup(this->bck_ctx);
+        }
+
+        /* Compute where each symbolic variable lives into seeds */
+        this->initLayout();
+
+        /* Directed exploration starts with the code reachable from the entry */
+        if (this->config.targets.size()) {
+          auto* cpu = this->ini_ctx->getCpuInstance();
+          this->cfg.disassemble(this->ini_ctx, triton::utils::cast<triton::uint64>(cpu->getConcreteRegisterValue(cpu->getProgramCounter())));
+          this->cfg.computeDistances(this->config.targets);
+        }
+
+        std::filesystem::create_directories(config.workspace + "/corpus");
+        std::filesystem::create_directories(config.workspace + "/crashes");
+        std::filesystem::create_directories(config.workspace + "/hangs");
+        std::filesystem::create_directories(config.workspace + "/coverage");
+        std::filesystem::create_directories(config.workspace + "/worklist");
+        if (this->config.trace) {
+          std::filesystem::create_directories(config.workspace + "/traces");
+          this->tracer.setSize(this->config.trace_size * 1024);
+        }
+
+        /* Every solver query is appended to the query file */
+        if (this->config.record_queries && this->recorder.isOpen() == false) {
+          this->recorder.open(this->config.workspace + "/queries.ttq");
+        }
+
+        /* Coverage events are streamed into the workspace as they happen */
+        if (this->config.coverage_timeline && this->timeline.isOpen() == false) {
+          this->timeline.open(this->config.workspace + "/coverage");
+        }
+
+        /* Cold seeds are spilled into the workspace beyond the budget */
+        this->worklist.setBudget(this->config.worklist_budget * 1024 * 1024, this->config.workspace + "/worklist");
+      }
+
+
       void SymbolicExplorator::initWorklist(void) {
         triton::engines::solver::status_e status;
-        auto model = this->ini_ctx->getModel(this->ini_ctx->getPathPredicate(), &status, this->config.timeout);
+        auto model = this->getModel(this->ini_ctx->getPathPredicate(), ORIGIN_INIT, 0, &status);
         if (status == triton::engines::solver::SAT) {
           this->nbsat++;
           /* If the model is SAT and empty, it means that any values satisfy the path predicate */
           if (model.size() == 0) {
-            for (const auto& item : this->ini_ctx->getSymbolicVariables()) {
-              model[item.first] = triton::engines::solver::SolverModel(item.second, 0x00);
-            }
+            this->worklist.push_back(Seed(SeedBytes(this->layoutSize, 0x00)));
+          }
+          else {
+            this->worklist.push_back(this->model2seed(model));
           }
-          this->worklist.push_back(model);
         }
         else if (status == triton::engines::solver::TIMEOUT) {
           this->nbtimeout++;
@@ -79,9 +239,6 @@ namespace triton {
         else {
           this->nbunsat++;
         }
-        std::filesystem::create_directories(config.workspace + "/corpus");
-        std::filesystem::create_directories(config.workspace + "/crashes");
-        std::filesystem::create_directories(config.workspace + "/coverage");
       }
 
 
@@ -96,71 +253,318 @@ namespace triton {
       }
 
 
+      void SymbolicExplorator::replay(const std::string& dir) {
+        if (this->ini_ctx == nullptr) {
+          throw triton::exceptions::Engines("SymbolicExplorator::replay(): The initial context cannot be null.");
+        }
+
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+          if (entry.is_regular_file()) {
+            files.push_back(entry.path());
+          }
+        }
+        std::sort(files.begin(), files.end());
+
+        this->initState();
+
+        /* Seeds are only executed concretely, nothing is solved */
+        this->mode = MODE_CONCRETE;
+        this->ini_ctx->enableSymbolicEngine(false);
+
+        for (const auto& path : files) {
+          std::ifstream f(path, std::ios::binary);
+          std::vector<triton::uint8> v((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+          auto seed = this->vector2seed(v);
+          this->injectSeed(seed);
+          this->run(seed);
+          this->snapshotContext(this->ini_ctx, this->bck_ctx);
+        }
+
+        this->ini_ctx->enableSymbolicEngine(true);
+        this->mode = MODE_SYMBOLIC;
+
+        if (this->config.stats) {
+          this->printStat();
+          this->printCrashes();
+        }
+        this->dumpCoverage();
+
+        /* Delete the allocated backup context */
+        if (this->loader) {
+          this->loader->setBackup(nullptr);
+        }
+        delete this->bck_ctx;
+        this->bck_ctx = nullptr;
+      }
+
+
       void SymbolicExplorator::writeSeedOnDisk(const std::string& dir, const Seed& seed) {
+        this->writeSeedOnDisk(dir, seed, std::to_string(this->nbexec));
+      }
+
+
+      void SymbolicExplorator::writeSeedOnDisk(const std::string& dir, const Seed& seed, const std::string& name) {
         std::ofstream f;
         auto v = this->seed2vector(seed);
-        f.open(this->config.workspace + "/" + dir + "/" + std::to_string(this->nbexec));
+        f.open(this->config.workspace + "/" + dir + "/" + name);
         f.write(reinterpret_cast<const char*>(v.data()), v.size());
         f.close();
       }
 
 
+      void SymbolicExplorator::triageCrash(const Seed& seed, const std::string& reason, triton::uint64 pc, const std::vector<triton::uint64>& trail, triton::usize trailIdx) {
+        /* Seeds replayed by taint runs are executed symbolically anyway */
+        if (this->mode == MODE_TAINT) {
+          return;
+        }
+
+        /* The bucket is the faulting pc plus the recent branches, from the oldest to the newest */
+        triton::uint64 key = hash64(0xcbf29ce484222325, pc);
+        for (triton::usize i = 0; i < trail.size(); i++) {
+          key = hash64(key, trail[(trailIdx + i) % trail.size()]);
+        }
+
+        triton::usize weight = 0;
+        for (const auto& byte : seed.bytes()) {
+          weight += (byte != 0);
+        }
+
+        std::stringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key;
+
+        this->nbcrash++;
+        auto it = this->crashes.find(key);
+        if (it == this->crashes.end()) {
+          std::cout << "[TT] " << reason << ", pc = 0x" << std::hex << pc << " (new crash bucket " << name.str() << ", writing seed on disk)" << std::dec << std::endl;
+          this->crashes[key] = {reason, pc, 1, weight};
+          this->writeSeedOnDisk("crashes", seed, name.str());
+          return;
+        }
+
+        /* Keep the smallest seed as representative of the bucket */
+        it->second.hits++;
+        if (weight < it->second.weight) {
+          it->second.weight = weight;
+          this->writeSeedOnDisk("crashes", seed, name.str());
+        }
+      }
+
+
+      void SymbolicExplorator::printCrashes(void) {
+        for (const auto& item : this->crashes) {
+          std::cout << "[TT] crash bucket " << std::hex << std::setw(16) << std::setfill('0') << item.first
+                    << ": pc = 0x" << item.second.pc
+                    << ",  hits: " << std::dec << item.second.hits
+                    << ",  " << item.second.reason
+                    << std::endl;
+        }
+      }
+
+
+      void SymbolicExplorator::updateWatchdog(triton::usize count, triton::usize ms) {
+        if (this->execInsts.size() < WATCHDOG_SAMPLES) {
+          this->execInsts.push_back(count);
+          this->execTimes.push_back(ms);
+        }
+        else {
+          this->execInsts[this->execSamples % WATCHDOG_SAMPLES] = count;
+          this->execTimes[this->execSamples % WATCHDOG_SAMPLES] = ms;
+        }
+        this->execSamples++;
+
+        /* The median is refreshed every WATCHDOG_WARMUP executions */
+        if (this->execSamples % WATCHDOG_WARMUP)
+          return;
+
+        auto insts = this->execInsts;
+        auto times = this->execTimes;
+        std::nth_element(insts.begin(), insts.begin() + insts.size() / 2, insts.end());
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        this->watchdogInst = std::max(insts[insts.size() / 2] * this->config.hang_factor, WATCHDOG_MIN_INST);
+        this->watchdogTime = std::max(times[times.size() / 2] * this->config.hang_factor, WATCHDOG_MIN_TIME);
+      }
+
+
       void SymbolicExplorator::asmret(void) {
         switch (this->ini_ctx->getArchitecture()) {
-          case triton::arch::ARCH_X86:
-          case triton::arch::ARCH_X86_64: {
-            auto ret = triton::arch::Instruction("\xc3", 1);
-            this->ini_ctx->processing(ret);
-            break;
-          }
+          case triton::arch::ARCH_X86:      return this->asmret<x86_s>();
+          case triton::arch::ARCH_X86_64:   return this->asmret<x8664_s>();
+          case triton::arch::ARCH_ARM32:    return this->asmret<arm32_s>();
+          case triton::arch::ARCH_AARCH64:  return this->asmret<aarch64_s>();
           default:
             throw triton::exceptions::Engines("SymbolicExplorator::asmret(): Invalid architecture");
         }
       }
 
 
+      template <typename Arch>
+      void SymbolicExplorator::asmret(void) {
+        auto ret = Arch::ret(this->ini_ctx);
+        this->ini_ctx->processing(ret);
+      }
+
+
       void SymbolicExplorator::run(const Seed& seed) {
-        triton::arch::CpuInterface* cpu = this->ini_ctx->getCpuInstance();
+        switch (this->ini_ctx->getArchitecture()) {
+          case triton::arch::ARCH_X86:      return this->run<x86_s>(seed);
+          case triton::arch::ARCH_X86_64:   return this->run<x8664_s>(seed);
+          case triton::arch::ARCH_ARM32:    return this->run<arm32_s>(seed);
+          case triton::arch::ARCH_AARCH64:  return this->run<aarch64_s>(seed);
+          default:
+            throw triton::exceptions::Engines("SymbolicExplorator::run(): Invalid architecture");
+        }
+      }
+
+
+      template <typename Arch>
+      void SymbolicExplorator::run(const Seed& seed) {
+        auto* cpu = static_cast<typename Arch::Cpu*>(this->ini_ctx->getCpuInstance());
 
         /* Init the program counter */
-        triton::arch::Register pcreg = cpu->getProgramCounter();
+        const triton::arch::Register& pcreg = Arch::pc(this->ini_ctx);
         triton::uint64 pcval = 0;
         triton::usize count = 0;
 
+        /* Ring of recent branches <src, dst> used to bucket crashes */
+        std::vector<triton::uint64> trail(this->config.crash_trail, 0);
+        triton::usize trailIdx = 0;
+        triton::uint64 branch = 0;
+
+        /* Effective addresses pinned by the previous execution */
+        this->pins.clear();
+        this->pinsByHash.clear();
+        this->pinsByVar.clear();
+
+        /* Watchdog limits, adapted from the median execution when not configured */
+        auto start = std::chrono::steady_clock::now();
+        triton::usize solved = this->solverTime;
+        triton::usize instLimit = this->config.hang_inst ? this->config.hang_inst : this->watchdogInst;
+        triton::usize timeLimit = this->config.hang_time ? this->config.hang_time : this->watchdogTime;
+
+        /* Wall-clock time of the execution, without the queries sent to the solver on the way */
+        auto elapsed = [&]() -> triton::usize {
+          triton::usize ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+          triton::usize solving = this->solverTime - solved;
+          return (ms > solving) ? ms - solving : 0;
+        };
+        bool hang = false;
+        bool crash = false;
+
+        /* Running hash of the symbolic branches <src, taken dst>, the same as the donelist keys */
+        triton::usize npcs = this->ini_ctx->getPathConstraints().size();
+        this->pathHash = 0xcbf29ce484222325;
+        this->runPriority = this->config.targets.size() ? CFG_UNREACHABLE : 0;
+
+        /* Executions are traced only in symbolic and concrete modes and kept if interesting */
+        bool tracing = (this->config.trace && this->mode != MODE_TAINT);
+        triton::usize icov = this->coverage.size();
+        triton::usize ecov = this->edges.size();
+        if (tracing) {
+          this->tracer.reset();
+        }
+
         do {
           if (this->config.limit_inst && count >= this->config.limit_inst) {
             break;
           }
 
-          pcval = triton::utils::cast<triton::uint64>(cpu->getConcreteRegisterValue(pcreg));
-          if (this->instHooks.find(pcval) != this->instHooks.end()) {
-            auto state = this->instHooks.at(pcval)(this->ini_ctx);
+          /* The clock is only read every 4096 instructions */
+          if (count >= instLimit || ((count & 0xfff) == 0 && timeLimit != HANG_OFF && elapsed() >= timeLimit)) {
+            hang = true;
+            break;
+          }
+
+          /* Qualified calls avoid the virtual dispatch through CpuInterface */
+          pcval = triton::utils::cast<triton::uint64>(cpu->Arch::Cpu::getConcreteRegisterValue(pcreg));
+          if (branch) {
+            triton::uint64 edge = hash64(branch, pcval);
+            if (this->config.targets.size()) {
+              this->cfg.addFlow(this->ini_ctx, branch, pcval);
+              this->runPriority = std::min(this->runPriority, this->cfg.distance(pcval));
+            }
+            if (trail.size()) {
+              trail[trailIdx++ % trail.size()] = edge;
+            }
+            if (this->edges.insert(edge).second && this->config.coverage_timeline) {
+              this->timeline.addEdge(branch, pcval, this->nbexec);
+            }
+            branch = 0;
+          }
+          if (const auto* hook = this->hooks.find(pcval)) {
+            auto state = (*hook)(this->ini_ctx);
             switch (state) {
               case triton::callbacks::CONTINUE:      continue;
               case triton::callbacks::BREAK:         goto stop_execution;
-              case triton::callbacks::PLT_CONTINUE:  this->asmret() ; continue;
+              case triton::callbacks::PLT_CONTINUE:  this->asmret<Arch>() ; continue;
             }
           }
-          else if (this->config.end_point && pcval == 0 || cpu->isConcreteMemoryValueDefined(pcval, 1) == false) {
-            std::cout << "[TT] Invalid control flow, pc = 0x" << std::hex << pcval << " (writing seed on disk)" << std::endl;
-            this->writeSeedOnDisk("crashes", seed);
-            break;
+
+          /* Map the code if needed, then fetch opcodes without running the memory hooks */
+          if (this->loader) {
+            this->loader->load(this->ini_ctx, pcval, 16);
           }
+          auto opcodes = this->ini_ctx->getConcreteMemoryAreaValue(pcval, 16, false);
 
-          /* Fetch opcodes */
-          auto opcodes = this->ini_ctx->getConcreteMemoryAreaValue(pcval, 16);
+          if ((this->config.end_point && pcval == 0) || cpu->Arch::Cpu::isConcreteMemoryValueDefined(pcval, 1) == false) {
+            this->triageCrash(seed, "Invalid control flow", pcval, trail, trailIdx);
+            if (tracing) {
+              this->tracer.record(pcval, false);
+            }
+            crash = true;
+            break;
+          }
 
           /* Execute instruction */
           triton::arch::Instruction inst(pcval, opcodes.data(), opcodes.size());
+
+          /* Taint runs stop as soon as an input byte reaches an address or the control flow */
+          if (this->mode == MODE_TAINT && this->isTaintedAddress(inst)) {
+            this->taintHit = true;
+            break;
+          }
+
           if (this->ini_ctx->processing(inst) != triton::arch::NO_FAULT) {
-            std::cout << "[TT] Invalid instruction, pc = 0x" << std::hex << pcval << " (writing seed on disk)" << std::endl;
-            this->writeSeedOnDisk("crashes", seed);
+            this->triageCrash(seed, "Invalid instruction", pcval, trail, trailIdx);
+            if (tracing) {
+              this->tracer.record(pcval, false);
+            }
+            crash = true;
             break;
           }
 
+          if (this->mode == MODE_TAINT) {
+            if (inst.isControlFlow() && inst.isTainted()) {
+              this->taintHit = true;
+              break;
+            }
+            count++;
+            continue;
+          }
+
+          /* The destination of the branch is known at the next instruction */
+          if (inst.isControlFlow()) {
+            branch = pcval;
+          }
+
+          if (tracing) {
+            this->tracer.record(pcval, inst.isControlFlow() && inst.isConditionTaken());
+          }
+
           //std::cout << inst << std::endl;
 
-          this->symbolizeEffectiveAddress(inst);
+          if (this->mode == MODE_SYMBOLIC) {
+            this->symbolizeEffectiveAddress(inst);
+            const auto& pcs = this->ini_ctx->getPathConstraints();
+            for (; npcs < pcs.size(); npcs++) {
+              this->pathHash = hash64(this->pathHash, pcs[npcs].getSourceAddress());
+              for (const auto& branch : pcs[npcs].getBranchConstraints()) {
+                if (std::get<0>(branch)) {
+                  this->pathHash = hash64(this->pathHash, std::get<2>(branch));
+                }
+              }
+            }
+          }
 
           /* Update the code coverage */
           if (this->coverage.find(pcval) != this->coverage.end()) {
@@ -168,6 +572,9 @@ namespace triton {
           }
           else {
             this->coverage[pcval] = 1;
+            if (this->config.coverage_timeline) {
+              this->timeline.addInstruction(pcval, inst.getSize(), this->nbexec);
+            }
           }
 
           count++;
@@ -175,29 +582,52 @@ namespace triton {
         while (this->config.end_point != pcval);
 
         stop_execution:
-        this->nbexec += 1;
-        this->writeSeedOnDisk("corpus", seed);
+        if (hang && this->mode != MODE_TAINT) {
+          std::cout << "[TT] Execution stopped by the watchdog after " << std::dec << count << " instructions (writing seed on disk)" << std::endl;
+          this->writeSeedOnDisk("hangs", seed);
+          this->nbhang++;
+        }
+
+        /* Only symbolic executions of normal length drive the watchdog */
+        if (this->mode == MODE_SYMBOLIC && hang == false) {
+          this->updateWatchdog(count, elapsed());
+        }
+
+        if (this->config.coverage_timeline) {
+          this->timeline.flush();
+        }
+
+        /* Traces of seeds that reach new coverage, crash or hang */
+        if (tracing && (hang || crash || this->coverage.size() != icov || this->edges.size() != ecov)) {
+          this->tracer.flush(this->config.workspace + "/traces/" + std::to_string(this->nbexec) + ".trace");
+        }
+        /* Taint runs are probes of a seed already executed, they do not name files */
+        if (this->mode != MODE_TAINT) {
+          this->nbexec += 1;
+        }
+        /* Concrete runs are only kept if they reach new coverage, see mutationStage() */
+        if (this->mode == MODE_SYMBOLIC) {
+          this->writeSeedOnDisk("corpus", seed);
+        }
       }
 
 
       void SymbolicExplorator::snapshotContext(triton::Context* dst, triton::Context* src) {
-        /* Synch concrete state */
         switch (src->getArchitecture()) {
-          case triton::arch::ARCH_X86_64:
-            *static_cast<triton::arch::x86::x8664Cpu*>(dst->getCpuInstance()) = *static_cast<triton::arch::x86::x8664Cpu*>(src->getCpuInstance());
-            break;
-          case triton::arch::ARCH_X86:
-            *static_cast<triton::arch::x86::x86Cpu*>(dst->getCpuInstance()) = *static_cast<triton::arch::x86::x86Cpu*>(src->getCpuInstance());
-            break;
-          case triton::arch::ARCH_ARM32:
-            *static_cast<triton::arch::arm::arm32::Arm32Cpu*>(dst->getCpuInstance()) = *static_cast<triton::arch::arm::arm32::Arm32Cpu*>(src->getCpuInstance());
-            break;
-          case triton::arch::ARCH_AARCH64:
-            *static_cast<triton::arch::arm::aarch64::AArch64Cpu*>(dst->getCpuInstance()) = *static_cast<triton::arch::arm::aarch64::AArch64Cpu*>(src->getCpuInstance());
-            break;
+          case triton::arch::ARCH_X86:      return this->snapshotContext<x86_s>(dst, src);
+          case triton::arch::ARCH_X86_64:   return this->snapshotContext<x8664_s>(dst, src);
+          case triton::arch::ARCH_ARM32:    return this->snapshotContext<arm32_s>(dst, src);
+          case triton::arch::ARCH_AARCH64:  return this->snapshotContext<aarch64_s>(dst, src);
           default:
             throw triton::exceptions::Engines("SymbolicExplorator::snapshotContext(): Invalid architecture");
         }
+      }
+
+
+      template <typename Arch>
+      void SymbolicExplorator::snapshotContext(triton::Context* dst, triton::Context* src) {
+        /* Synch concrete state */
+        *static_cast<typename Arch::Cpu*>(dst->getCpuInstance()) = *static_cast<typename Arch::Cpu*>(src->getCpuInstance());
 
         /* Synch symbolic register */
         dst->concretizeAllRegister();
@@ -242,13 +672,21 @@ namespace triton {
               if (this->donelist.find(pathaddrs) == this->donelist.end()) {
                 /* Adding the path encoding to the donelist */
                 this->donelist.insert(pathaddrs);
-                /* constraint := (pc && ea != ea.eval) */
-                auto c = ast->land(this->ini_ctx->getPathPredicate(), ast->distinct(ea, ast->bv(ea->evaluate(), ea->getBitvectorSize())));
-                auto models = this->ini_ctx->getModels(c, this->config.ea_model, &status, this->config.timeout);
+                /* constraint := (pc && pins sharing variables with ea && ea != ea.eval) */
+                std::unordered_set<const triton::ast::AbstractNode*> visited;
+                std::set<triton::usize> vars;
+                Presolver::collectVariables(ea, visited, vars);
+                std::vector<triton::usize> fresh(vars.begin(), vars.end());
+                std::vector<bool> used(this->pins.size(), false);
+                std::vector<triton::ast::SharedAbstractNode> nodes = {this->ini_ctx->getPathPredicate()};
+                this->collectPins(vars, fresh, this->ini_ctx->getPathConstraints().size(), used, nodes);
+                nodes.push_back(ast->distinct(ea, ast->bv(ea->evaluate(), ea->getBitvectorSize())));
+                auto c = ast->land(nodes);
+                auto models = this->getModels(c, this->config.ea_model, ORIGIN_EA, inst.getAddress(), &status);
                 if (status == triton::engines::solver::SAT) {
-                  for (auto model : models) {
+                  for (const auto& model : models) {
                     this->nbsat++;
-                    this->worklist.push_front(model);
+                    this->worklist.push_front(this->model2seed(model), this->priority(inst.getAddress()));
                   }
                 }
                 else if (status == triton::engines::solver::TIMEOUT) {
@@ -258,8 +696,94 @@ namespace triton {
                   this->nbunsat++;
                 }
               }
-              // Enforce the value of the EA into the current path predicate
-              this->ini_ctx->pushPathConstraint(ast->equal(ea, ast->bv(ea->evaluate(), ea->getBitvectorSize())));
+              /* Enforce the value of the EA, apart from the path predicate */
+              this->pinEffectiveAddress(ea);
+            }
+          }
+        }
+      }
+
+
+      void SymbolicExplorator::pinEffectiveAddress(const triton::ast::SharedAbstractNode& ea) {
+        auto ast = this->ini_ctx->getAstContext();
+        std::unordered_map<const triton::ast::AbstractNode*, bool> memo;
+
+        /* The same expression pinned twice, or a function of pinned expressions */
+        if (this->isPinned(ea, memo))
+          return;
+
+        pin_s pin;
+        pin.ea = ea;
+        pin.constraint = ast->equal(ea, ast->bv(ea->evaluate(), ea->getBitvectorSize()));
+        pin.index = this->ini_ctx->getPathConstraints().size();
+        std::unordered_set<const triton::ast::AbstractNode*> visited;
+        Presolver::collectVariables(ea, visited, pin.vars);
+
+        triton::usize id = this->pins.size();
+        this->pinsByHash[ea->getHash()] = id;
+        for (const auto& var : pin.vars) {
+          this->pinsByVar[var].push_back(id);
+        }
+        this->pins.push_back(std::move(pin));
+      }
+
+
+      bool SymbolicExplorator::isPinned(const triton::ast::SharedAbstractNode& node, std::unordered_map<const triton::ast::AbstractNode*, bool>& memo) {
+        if (node->isSymbolized() == false)
+          return true;
+
+        auto it = memo.find(node.get());
+        if (it != memo.end())
+          return it->second;
+
+        /* The walk is bounded, large expressions are pinned as they are */
+        if (memo.size() >= PIN_IMPLIED_NODES)
+          return false;
+
+        bool pinned = true;
+        auto pin = this->pinsByHash.find(node->getHash());
+        if (pin == this->pinsByHash.end() || (this->pins[pin->second].ea != node && this->pins[pin->second].ea->equalTo(node) == false)) {
+          switch (node->getType()) {
+            case triton::ast::VARIABLE_NODE:
+              pinned = false;
+              break;
+            case triton::ast::REFERENCE_NODE:
+              pinned = this->isPinned(reinterpret_cast<triton::ast::ReferenceNode*>(node.get())->getSymbolicExpression()->getAst(), memo);
+              break;
+            default:
+              for (const auto& child : node->getChildren()) {
+                if (this->isPinned(child, memo) == false) {
+                  pinned = false;
+                  break;
+                }
+              }
+          }
+        }
+
+        memo[node.get()] = pinned;
+        return pinned;
+      }
+
+
+      void SymbolicExplorator::collectPins(std::set<triton::usize>& vars, std::vector<triton::usize> fresh, triton::usize upto, std::vector<bool>& used, std::vector<triton::ast::SharedAbstractNode>& nodes) {
+        while (fresh.size()) {
+          auto it = this->pinsByVar.find(fresh.back());
+          fresh.pop_back();
+          if (it == this->pinsByVar.end())
+            continue;
+          /* Pins of a variable are sorted by index */
+          for (const auto& id : it->second) {
+            const auto& pin = this->pins[id];
+            if (pin.index > upto)
+              break;
+            if (used[id])
+              continue;
+            used[id] = true;
+            nodes.push_back(pin.constraint);
+            for (const auto& var : pin.vars) {
+              if (vars.insert(var).second) {
+                fresh.push_back(var);
+              }
             }
           }
         }
@@ -272,10 +796,38 @@ namespace triton {
         auto pcs = this->ini_ctx->getPathConstraints();
         auto ast = this->ini_ctx->getAstContext();
 
+        /* Variables constrained by the path prefix, used by the input-to-state fast path and to select pins */
+        std::unordered_set<const triton::ast::AbstractNode*> visited;
+        std::set<triton::usize> prefixVars;
+        std::vector<triton::usize> freshVars;
+        Presolver presolver(this->ini_ctx);
+        Model i2s;
+
+        /* Pins already in the predicate, and the next one to consider */
+        std::vector<bool> used(this->pins.size(), false);
+        triton::usize nextPin = 0;
+        triton::usize index = 0;
+
         /* Building path predicate. Starting wite True. */
         auto predicate = ast->equal(ast->bvtrue(), ast->bvtrue());
 
         for (const auto& pc : pcs) {
+          /* Pins made before this branch join the prefix once they share variables with it */
+          if (this->pins.size()) {
+            std::vector<triton::ast::SharedAbstractNode> nodes = {predicate};
+            for (; nextPin < this->pins.size() && this->pins[nextPin].index <= index; nextPin++) {
+              const auto& pin = this->pins[nextPin];
+              if (used[nextPin] == false && std::any_of(pin.vars.begin(), pin.vars.end(), [&](triton::usize var) { return prefixVars.count(var) != 0; })) {
+                this->collectPins(prefixVars, std::vector<triton::usize>(pin.vars.begin(), pin.vars.end()), index, used, nodes);
+              }
+            }
+            this->collectPins(prefixVars, freshVars, index, used, nodes);
+            freshVars.clear();
+            if (nodes.size() > 1) {
+              predicate = ast->land(nodes);
+            }
+          }
+
           pathaddrs.push_back(pc.getSourceAddress());
           for (const auto& branch : pc.getBranchConstraints()) {
             /* Do we already generated a model? */
@@ -290,11 +842,89 @@ namespace triton {
             /* MultipleBranches is true if the instruction is like jz, jb etc. */
             if (pc.isMultipleBranches()) {
               if (std::get<0>(branch) == false) {
-                auto c = ast->land(predicate, std::get<3>(branch));
-                auto model = this->ini_ctx->getModel(c, &status, this->config.timeout);
+                /* The target is already covered by another seed, skip the flip or solve it last */
+                bool covered = this->isCovered(pc.getSourceAddress(), std::get<2>(branch), this->config.skip_covered);
+                if (covered && this->config.deprioritize_covered == false) {
+                  this->nbskip++;
+                  continue;
+                }
+                /* Pins of the variables of the branch only, the ones of the prefix are already in */
+                std::vector<triton::ast::SharedAbstractNode> nodes = {predicate};
+                if (this->pins.size()) {
+                  std::unordered_set<const triton::ast::AbstractNode*> seen;
+                  std::set<triton::usize> vars;
+                  std::vector<triton::usize> fresh;
+                  Presolver::collectVariables(std::get<3>(branch), seen, vars);
+                  for (const auto& var : vars) {
+                    if (prefixVars.find(var) == prefixVars.end()) {
+                      fresh.push_back(var);
+                    }
+                  }
+                  auto flipUsed = used;
+                  this->collectPins(vars, fresh, index, flipUsed, nodes);
+                }
+                bool pinned = (nodes.size() > 1);
+                nodes.push_back(std::get<3>(branch));
+                auto c = ast->land(nodes);
+                if (covered) {
+                  auto query = std::make_shared<query_s>();
+                  query->kind = QUERY_FLIP;
+                  query->constraint = c;
+                  query->branch = std::get<3>(branch);
+                  query->src = pc.getSourceAddress();
+                  query->dst = std::get<2>(branch);
+                  query->parent = this->current;
+                  query->deprioritized = true;
+                  this->nbdeprio++;
+                  this->worklist.push_back(query, this->priority(query->dst));
+                  continue;
+                }
+                /*
+                 * Input-to-state: the branch is a comparison between the input and a constant.
+                 * Patch the input bytes directly, as long as they are not constrained by the
+                 * path prefix. Otherwise, ask the solver.
+                 */
+                if (this->config.input_to_state && pinned == false && presolver.inputToState(std::get<3>(branch), i2s)) {
+                  bool independent = true;
+                  for (const auto& item : i2s) {
+                    independent &= (prefixVars.find(item.first) == prefixVars.end());
+                  }
+                  if (independent) {
+                    this->nbi2s++;
+                    this->worklist.push_front(this->model2seed(i2s), this->priority(std::get<2>(branch)));
+                    continue;
+                  }
+                }
+                /* Defer the solving until the query is picked from the worklist */
+                if (this->config.lazy_solving) {
+                  auto query = std::make_shared<query_s>();
+                  query->kind = QUERY_FLIP;
+                  query->constraint = c;
+                  query->branch = std::get<3>(branch);
+                  query->src = pc.getSourceAddress();
+                  query->dst = std::get<2>(branch);
+                  query->parent = this->current;
+                  this->worklist.push_front(query, this->priority(query->dst));
+                  continue;
+                }
+                /* Trivial queries are settled without the solver */
+                if (this->config.presolve) {
+                  Model model;
+                  status = this->presolveQuery(c, this->current, model);
+                  if (status == triton::engines::solver::SAT) {
+                    this->nbpresolve++;
+                    this->worklist.push_front(this->model2seed(model), this->priority(std::get<2>(branch)));
+                    continue;
+                  }
+                  if (status == triton::engines::solver::UNSAT) {
+                    this->nbpresolve++;
+                    continue;
+                  }
+                }
+                auto model = this->config.model_hints ? this->getHintedModel(c, std::get<3>(branch), this->current, pc.getSourceAddress(), &status) : this->getModel(c, ORIGIN_FLIP, pc.getSourceAddress(), &status);
                 if (status == triton::engines::solver::SAT) {
                   this->nbsat++;
-                  this->worklist.push_front(model);
+                  this->worklist.push_front(this->model2seed(model), this->priority(std::get<2>(branch)));
                 }
                 else if (status == triton::engines::solver::TIMEOUT) {
                   this->nbtimeout++;
@@ -306,74 +936,656 @@ namespace triton {
             }
             /* MultipleBranches is false if the instruction is like jmp rax */
             else {
-              auto c = ast->land(predicate, ast->lnot(std::get<3>(branch)));
-              auto models = this->ini_ctx->getModels(c, this->config.jmp_model, &status, this->config.timeout);
-              if (status == triton::engines::solver::SAT) {
-                for (const auto& model : models) {
-                  this->nbsat++;
-                  this->worklist.push_front(model);
-                }
-              }
-              else if (status == triton::engines::solver::TIMEOUT) {
-                this->nbtimeout++;
-              }
-              else {
-                this->nbunsat++;
+              /*
+               * Targets are enumerated one at a time as the worklist drains. The jump
+               * target is bound to a fresh variable so that each model excludes the
+               * targets already produced, instead of the raw input bytes. The variable
+               * is not registered into the context, so the layout of seeds is unchanged.
+               * Targets are shared by the jump site: a child that takes a target already
+               * produced adds it to the set instead of starting a new enumeration.
+               */
+              const auto& node = std::get<3>(branch);
+              if (node->getType() != triton::ast::EQUAL_NODE)
+                continue;
+              auto& targets = this->jumpTargets[pathaddrs];
+              if (targets != nullptr) {
+                targets->insert(std::get<2>(branch));
+                continue;
               }
+              targets = std::make_shared<std::set<triton::uint64>>();
+              targets->insert(std::get<2>(branch));
+              auto target = std::make_shared<triton::engines::symbolic::SymbolicVariable>(
+                triton::engines::symbolic::UNDEFINED_VARIABLE, 0, JMP_VARIABLE_BASE + this->nbjmpvar++, node->getChildren()[0]->getBitvectorSize()
+              );
+              auto query = std::make_shared<query_s>();
+              query->kind = QUERY_JMP;
+              query->constraint = ast->land(predicate, ast->equal(ast->variable(target), node->getChildren()[0]));
+              query->src = pc.getSourceAddress();
+              query->dst = std::get<2>(branch);
+              query->parent = this->current;
+              query->target = target;
+              query->targets = targets;
+              this->worklist.push_front(query, this->priority(query->src));
             }
           }
         predicate = ast->land(predicate, pc.getTakenPredicate());
+        if (this->config.input_to_state || this->pins.size()) {
+          std::set<triton::usize> vars;
+          Presolver::collectVariables(pc.getTakenPredicate(), visited, vars);
+          for (const auto& var : vars) {
+            if (prefixVars.insert(var).second) {
+              freshVars.push_back(var);
+            }
+          }
+        }
+        index++;
         }
       }
 
 
       std::vector<triton::uint8> SymbolicExplorator::seed2vector(const Seed& seed) {
-        std::vector<triton::uint8> ret;
+        return seed.bytes();
+      }
+
+
+      Seed SymbolicExplorator::vector2seed(const std::vector<triton::uint8>& v) {
+        SeedBytes bytes(v.begin(), v.begin() + std::min(v.size(), this->layoutSize));
+        bytes.resize(this->layoutSize, 0x00);
+        return Seed(std::move(bytes));
+      }
+
+
+      void SymbolicExplorator::initLayout(void) {
+        this->layout.clear();
+        this->layoutSize = 0;
+
+        /* Variables are laid out by id, each one taking its size in bytes */
+        for (const auto& item : this->ini_ctx->getSymbolicVariables()) {
+          if (item.first >= this->layout.size()) {
+            this->layout.resize(item.first + 1);
+          }
+          auto& entry = this->layout[item.first];
+          entry.var = item.second;
+          entry.offset = this->layoutSize;
+          entry.size = (item.second->getSize() + 7) / 8;
+          this->layoutSize += entry.size;
+        }
+
+        /* Keep track of the values currently held by the variables */
+        this->injected.assign(this->layoutSize, 0x00);
+        for (const auto& entry : this->layout) {
+          if (entry.var == nullptr)
+            continue;
+          auto value = this->ini_ctx->getConcreteVariableValue(entry.var);
+          for (triton::uint32 i = 0; i < entry.size; i++) {
+            this->injected[entry.offset + i] = triton::utils::cast<triton::uint8>((value >> (i * 8)) & 0xff);
+          }
+        }
+        this->initial = this->injected;
+        this->current = std::make_shared<const SeedBytes>(this->injected);
+      }
 
-        const auto vars = this->ini_ctx->getSymbolicVariables();
-        ret.resize(vars.size());
-        for (triton::usize i = 0; i < vars.size(); i++) {
-          if (seed.find(i) == seed.end())
-            ret[i] = 0x00;
-          else
-            ret[i] = triton::utils::cast<triton::uint8>(seed.at(i).getValue());
+
+      void SymbolicExplorator::writeVariable(const layout_s& entry, const SeedBytes& bytes) {
+        switch (entry.var->getType()) {
+          case triton::engines::symbolic::MEMORY_VARIABLE:
+            for (triton::uint32 i = 0; i < entry.size; i++) {
+              this->ini_ctx->setConcreteMemoryValue(entry.var->getOrigin() + i, bytes[entry.offset + i], false);
+            }
+            break;
+          case triton::engines::symbolic::REGISTER_VARIABLE: {
+            triton::uint512 value = 0;
+            for (triton::uint32 i = entry.size; i > 0; i--) {
+              value = (value << 8) | bytes[entry.offset + i - 1];
+            }
+            this->ini_ctx->setConcreteRegisterValue(this->ini_ctx->getRegister(static_cast<triton::arch::register_e>(entry.var->getOrigin())), value, false);
+            break;
+          }
+          default:
+            break;
+        }
+      }
+
+
+      Seed SymbolicExplorator::model2seed(const Model& model) {
+        return this->model2seed(model, this->current);
+      }
+
+
+      Seed SymbolicExplorator::model2seed(const Model& model, const std::shared_ptr<const SeedBytes>& parent) {
+        std::vector<SeedPatch> patches;
+
+        for (const auto& item : model) {
+          if (item.first >= this->layout.size() || this->layout[item.first].var == nullptr)
+            continue;
+          const auto& entry = this->layout[item.first];
+          const auto& value = item.second.getValue();
+          for (triton::uint32 i = 0; i < entry.size; i++) {
+            auto byte = triton::utils::cast<triton::uint8>((value >> (i * 8)) & 0xff);
+            if ((*parent)[entry.offset + i] != byte) {
+              patches.push_back(SeedPatch(entry.offset + i, byte));
+            }
+          }
+        }
+
+        std::sort(patches.begin(), patches.end());
+        return Seed(parent, std::move(patches));
+      }
+
+
+      Model SymbolicExplorator::getModel(const triton::ast::SharedAbstractNode& node, origin_e origin, triton::uint64 addr, triton::engines::solver::status_e* status) {
+        auto start = std::chrono::steady_clock::now();
+        auto model = this->ini_ctx->getModel(node, status, this->config.timeout);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        this->solverTime += ms;
+        if (this->config.solver_profile) {
+          this->profileQuery(node, origin, addr, *status, ms);
+        }
+        if (this->recorder.isOpen()) {
+          this->recordQuery(node, origin, addr, *status, ms, 1);
+        }
+        return model;
+      }
+
+
+      std::vector<Model> SymbolicExplorator::getModels(const triton::ast::SharedAbstractNode& node, triton::usize limit, origin_e origin, triton::uint64 addr, triton::engines::solver::status_e* status) {
+        auto start = std::chrono::steady_clock::now();
+        auto models = this->ini_ctx->getModels(node, limit, status, this->config.timeout);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        this->solverTime += ms;
+        if (this->config.solver_profile) {
+          this->profileQuery(node, origin, addr, *status, ms);
+        }
+        if (this->recorder.isOpen()) {
+          this->recordQuery(node, origin, addr, *status, ms, limit);
+        }
+        return models;
+      }
+
+
+      triton::engines::solver::status_e SymbolicExplorator::presolveQuery(const triton::ast::SharedAbstractNode& node, const std::shared_ptr<const SeedBytes>& parent, Model& model) {
+        Presolver presolver(this->ini_ctx);
+        auto base = [&](const triton::engines::symbolic::SharedSymbolicVariable& var) { return this->seedValue(var, parent); };
+        return presolver.presolve(node, base, model);
+      }
+
+
+      triton::uint512 SymbolicExplorator::seedValue(const triton::engines::symbolic::SharedSymbolicVariable& var, const std::shared_ptr<const SeedBytes>& seed) {
+        /* Variables created after the layout, e.g. jump targets, are not part of seeds */
+        if (var->getId() >= this->layout.size() || this->layout[var->getId()].var == nullptr)
+          return this->ini_ctx->getConcreteVariableValue(var);
+
+        /* Little endian, like injectSeed() */
+        const auto& entry = this->layout[var->getId()];
+        triton::uint512 value = 0;
+        for (triton::uint32 i = entry.size; i > 0; i--) {
+          value = (value << 8) | (*seed)[entry.offset + i - 1];
+        }
+        return value;
+      }
+
+
+      Model SymbolicExplorator::getHintedModel(const triton::ast::SharedAbstractNode& node, const triton::ast::SharedAbstractNode& branch, const std::shared_ptr<const SeedBytes>& parent, triton::uint64 addr, triton::engines::solver::status_e* status) {
+        auto ast = this->ini_ctx->getAstContext();
+
+        std::unordered_set<const triton::ast::AbstractNode*> visited;
+        std::set<triton::usize> vars;
+        std::set<triton::usize> forced;
+        Presolver::collectVariables(node, visited, vars);
+        visited.clear();
+        Presolver::collectVariables(branch, visited, forced);
+
+        /* Variables only constrained by the prefix keep their parent value, the parent satisfies it */
+        std::vector<triton::ast::SharedAbstractNode> pins;
+        for (const auto& id : vars) {
+          if (forced.find(id) != forced.end() || id >= this->layout.size() || this->layout[id].var == nullptr)
+            continue;
+          const auto& var = this->layout[id].var;
+          pins.push_back(ast->equal(ast->variable(var), ast->bv(this->seedValue(var, parent), var->getSize())));
+        }
+        if (pins.empty()) {
+          return this->getModel(node, ORIGIN_FLIP, addr, status);
+        }
+
+        pins.push_back(node);
+        auto model = this->getModel(ast->land(pins), ORIGIN_FLIP, addr, status);
+        if (*status == triton::engines::solver::SAT) {
+          this->nbhint++;
+          return model;
+        }
+
+        /* The prefix relates pinned variables to the flipped ones */
+        if (*status == triton::engines::solver::UNSAT) {
+          return this->getModel(node, ORIGIN_FLIP, addr, status);
+        }
+        return model;
+      }
+
+
+      void SymbolicExplorator::profileQuery(const triton::ast::SharedAbstractNode& node, origin_e origin, triton::uint64 addr, triton::engines::solver::status_e status, triton::usize ms) {
+        auto& site = this->sites[std::make_pair(addr, origin)];
+
+        /* Size of the AST as sent to the solver, references unrolled */
+        std::unordered_set<const triton::ast::AbstractNode*> visited;
+        std::set<triton::usize> vars;
+        Presolver::collectVariables(node, visited, vars);
+
+        site.calls++;
+        site.sat     += (status == triton::engines::solver::SAT);
+        site.unsat   += (status == triton::engines::solver::UNSAT);
+        site.timeout += (status == triton::engines::solver::TIMEOUT);
+        site.total   += ms;
+        site.max      = std::max(site.max, ms);
+        site.nodes   += visited.size();
+      }
+
+
+      void SymbolicExplorator::recordQuery(const triton::ast::SharedAbstractNode& node, origin_e origin, triton::uint64 addr, triton::engines::solver::status_e status, triton::usize ms, triton::usize limit) {
+        record_s header;
+        header.origin  = static_cast<triton::uint8>(origin);
+        header.status  = static_cast<triton::uint8>(status);
+        header.limit   = static_cast<triton::uint16>(std::min<triton::usize>(limit, 0xffff));
+        header.timeout = static_cast<triton::uint32>(this->config.timeout);
+        header.addr    = addr;
+        header.latency = static_cast<triton::uint32>(ms);
+        header.length  = 0;
+        this->recorder.record(node, header);
+      }
+
+
+      void SymbolicExplorator::writeSolverProfile(void) {
+        static const char* origins[] = {"init", "flip", "ea", "jmp"};
+        std::vector<std::pair<std::pair<triton::uint64, origin_e>, site_s>> sorted(this->sites.begin(), this->sites.end());
+
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second.total > b.second.total; });
+
+        std::ofstream f;
+        f.open(this->config.workspace + "/solver_profile.txt");
+        f << "# addr origin calls sat unsat timeout total_ms max_ms avg_nodes" << std::endl;
+        for (const auto& item : sorted) {
+          const auto& site = item.second;
+          f << "0x" << std::hex << item.first.first << std::dec
+            << " " << origins[item.first.second]
+            << " " << site.calls
+            << " " << site.sat
+            << " " << site.unsat
+            << " " << site.timeout
+            << " " << site.total
+            << " " << site.max
+            << " " << (site.nodes / site.calls)
+            << std::endl;
+        }
+        f.close();
+        std::cout << "[TT] Solver profile has been written in " << this->config.workspace << "/solver_profile.txt" << std::endl;
+      }
+
+
+      triton::usize SymbolicExplorator::priority(triton::uint64 addr) {
+        if (this->config.targets.empty()) {
+          return 0;
+        }
+        return this->cfg.distance(addr);
+      }
+
+
+      void SymbolicExplorator::checkTargets(void) {
+        for (const auto& target : this->config.targets) {
+          if (this->reached.find(target) == this->reached.end() && this->coverage.find(target) != this->coverage.end()) {
+            std::cout << "[TT] Target 0x" << std::hex << target << std::dec << " reached after " << this->nbexec << " executions" << std::endl;
+            this->reached.insert(target);
+          }
+        }
+      }
+
+
+      bool SymbolicExplorator::isCovered(triton::uint64 src, triton::uint64 dst, cover_e policy) {
+        switch (policy) {
+          case COVER_INST: return this->coverage.find(dst) != this->coverage.end();
+          case COVER_EDGE: return this->edges.find(hash64(src, dst)) != this->edges.end();
+          default:         return false;
+        }
+      }
+
+
+      bool SymbolicExplorator::solveQuery(const std::shared_ptr<query_s>& query, Seed& seed) {
+        triton::engines::solver::status_e status;
+        auto ast = this->ini_ctx->getAstContext();
+        auto c = query->constraint;
+
+        switch (query->kind) {
+          case QUERY_FLIP:
+            /* The target has been covered by another seed since the query was discovered */
+            if (query->deprioritized == false && this->isCovered(query->src, query->dst, (this->config.skip_covered != COVER_NONE) ? this->config.skip_covered : COVER_INST)) {
+              this->nbskip++;
+              return false;
+            }
+            break;
+
+          case QUERY_JMP: {
+            /* Stop the enumeration once the limit of targets is reached */
+            if (query->targets->size() > this->config.jmp_model) {
+              return false;
+            }
+            auto var = ast->variable(query->target);
+            for (const auto& addr : *query->targets) {
+              c = ast->land(c, ast->distinct(var, ast->bv(addr, var->getBitvectorSize())));
+            }
+            break;
+          }
+        }
+
+        /* Trivial flips are settled without the solver */
+        if (query->kind == QUERY_FLIP && this->config.presolve) {
+          Model model;
+          status = this->presolveQuery(c, query->parent, model);
+          if (status == triton::engines::solver::SAT) {
+            this->nbpresolve++;
+            seed = this->model2seed(model, query->parent);
+            return true;
+          }
+          if (status == triton::engines::solver::UNSAT) {
+            this->nbpresolve++;
+            return false;
+          }
+        }
+
+        Model model;
+        if (query->kind == QUERY_FLIP && this->config.model_hints) {
+          model = this->getHintedModel(c, query->branch, query->parent, query->src, &status);
+        }
+        else {
+          model = this->getModel(c, (query->kind == QUERY_JMP) ? ORIGIN_JMP : ORIGIN_FLIP, query->src, &status);
+        }
+        if (status == triton::engines::solver::SAT) {
+          this->nbsat++;
+          seed = this->model2seed(model, query->parent);
+          /* Keep enumerating targets the next time the worklist drains up to this query */
+          if (query->kind == QUERY_JMP && model.find(query->target->getId()) != model.end()) {
+            query->targets->insert(triton::utils::cast<triton::uint64>(model.at(query->target->getId()).getValue()));
+            this->worklist.push_back(query, this->priority(query->src));
+          }
+          return true;
+        }
+        else if (status == triton::engines::solver::TIMEOUT) {
+          this->nbtimeout++;
+        }
+        else {
+          this->nbunsat++;
         }
 
-        return ret;
+        return false;
       }
 
 
       void SymbolicExplorator::injectSeed(const Seed& seed) {
-        for (const auto& item : seed) {
-          auto var = this->ini_ctx->getSymbolicVariable(item.first);
-          this->ini_ctx->setConcreteVariableValue(var, item.second.getValue());
+        auto bytes = std::make_shared<SeedBytes>(seed.bytes());
+
+        /*
+         * The symbolic engine is disabled, write the seed into the machine state and drop
+         * the symbolic state so that instructions are only executed concretely. Variables
+         * keep their values, the state is restored from the backup context after the run.
+         */
+        if (this->mode != MODE_SYMBOLIC) {
+          for (const auto& entry : this->layout) {
+            if (entry.var == nullptr)
+              continue;
+            this->writeVariable(entry, *bytes);
+          }
+          this->ini_ctx->concretizeAllRegister();
+          this->ini_ctx->concretizeAllMemory();
+          this->current = bytes;
+          return;
+        }
+
+        /*
+         * Variable values live in the AST context and survive a restore of the backup
+         * context, while the machine state goes back to the initial bytes. A variable is
+         * updated only if its value changed since the previous injection, and its origin
+         * is written if it differs from the initial bytes. Both are done without running
+         * the memory hooks.
+         */
+        for (const auto& entry : this->layout) {
+          if (entry.var == nullptr)
+            continue;
+          auto begin = bytes->begin() + entry.offset;
+          auto end   = begin + entry.size;
+          if (!std::equal(begin, end, this->injected.begin() + entry.offset)) {
+            triton::uint512 value = 0;
+            for (triton::uint32 i = entry.size; i > 0; i--) {
+              value = (value << 8) | (*bytes)[entry.offset + i - 1];
+            }
+            this->ini_ctx->getAstContext()->updateVariable(entry.var->getName(), value);
+            this->writeVariable(entry, *bytes);
+            std::copy(begin, end, this->injected.begin() + entry.offset);
+          }
+          else if (!std::equal(begin, end, this->initial.begin() + entry.offset)) {
+            this->writeVariable(entry, *bytes);
+          }
         }
+
+        this->current = bytes;
       }
 
 
-      std::stringstream SymbolicExplorator::seedRepr(void) {
+      std::stringstream SymbolicExplorator::seedRepr(const Seed& seed) {
         std::stringstream ss;
-        auto vars = this->ini_ctx->getSymbolicVariables();
-        for (triton::usize i = 0; i < vars.size(); i++) {
-          ss << std::hex << std::setw(2) << std::setfill('0') << this->ini_ctx->getConcreteVariableValue(vars[i]) << " ";
+        for (const auto& byte : seed.bytes()) {
+          ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<triton::uint32>(byte) << " ";
         }
         return ss;
       }
 
 
+      bool SymbolicExplorator::isTaintedAddress(triton::arch::Instruction& inst) {
+        this->ini_ctx->disassembly(inst);
+        for (const auto& operand : inst.operands) {
+          if (operand.getType() != triton::arch::OP_MEM)
+            continue;
+          const auto& base  = operand.getConstMemory().getConstBaseRegister();
+          const auto& index = operand.getConstMemory().getConstIndexRegister();
+          if (base.getId() != triton::arch::ID_REG_INVALID && this->ini_ctx->isRegisterTainted(base))
+            return true;
+          if (index.getId() != triton::arch::ID_REG_INVALID && this->ini_ctx->isRegisterTainted(index))
+            return true;
+        }
+        return false;
+      }
+
+
+      bool SymbolicExplorator::taintRun(const Seed& seed, const std::vector<triton::usize>& vars) {
+        this->mode = MODE_TAINT;
+        this->ini_ctx->enableSymbolicEngine(false);
+        this->injectSeed(seed);
+
+        for (const auto& id : vars) {
+          const auto& var = this->layout[id].var;
+          for (triton::uint32 i = 0; i < this->layout[id].size; i++) {
+            this->ini_ctx->taintMemory(var->getOrigin() + i);
+          }
+        }
+
+        this->taintHit = false;
+        this->run(seed);
+
+        /* The taint is not part of the snapshot */
+        for (const auto& addr : this->ini_ctx->getTaintedMemory()) {
+          this->ini_ctx->untaintMemory(addr);
+        }
+        for (const auto* reg : this->ini_ctx->getTaintedRegisters()) {
+          this->ini_ctx->untaintRegister(*reg);
+        }
+
+        this->snapshotContext(this->ini_ctx, this->bck_ctx);
+        this->ini_ctx->enableSymbolicEngine(true);
+        this->mode = MODE_SYMBOLIC;
+
+        return this->taintHit;
+      }
+
+
+      std::set<triton::usize> SymbolicExplorator::taintRelevant(const Seed& seed, const std::vector<triton::usize>& vars) {
+        std::set<triton::usize> relevant;
+        std::list<std::vector<triton::usize>> groups;
+
+        /* Group testing: a group that does not reach anything is dropped, otherwise it is split */
+        if (vars.size()) {
+          groups.push_back(vars);
+        }
+        while (groups.size()) {
+          auto group = std::move(groups.front());
+          groups.pop_front();
+          if (this->taintRun(seed, group) == false)
+            continue;
+          if (group.size() == 1) {
+            relevant.insert(group[0]);
+            continue;
+          }
+          auto half = group.begin() + group.size() / 2;
+          groups.push_back(std::vector<triton::usize>(group.begin(), half));
+          groups.push_back(std::vector<triton::usize>(half, group.end()));
+        }
+
+        return relevant;
+      }
+
+
+      void SymbolicExplorator::shrinkInput(const Seed& seed) {
+        std::vector<triton::usize> vars;
+
+        /* Only memory variables are candidates, registers stay symbolic */
+        for (const auto& entry : this->layout) {
+          if (entry.var != nullptr && entry.var->getType() == triton::engines::symbolic::MEMORY_VARIABLE) {
+            vars.push_back(entry.var->getId());
+          }
+        }
+
+        auto relevant = this->taintRelevant(seed, vars);
+        for (const auto& id : vars) {
+          if (relevant.find(id) != relevant.end())
+            continue;
+          const auto& entry = this->layout[id];
+          for (triton::uint32 i = 0; i < entry.size; i++) {
+            triton::uint64 addr = entry.var->getOrigin() + i;
+            auto expr = this->bck_ctx->getSymbolicMemory(addr);
+            if (expr != nullptr) {
+              this->dormantMem[addr] = expr;
+              this->bck_ctx->concretizeMemory(addr);
+            }
+          }
+          this->dormant.insert(id);
+        }
+        this->snapshotContext(this->ini_ctx, this->bck_ctx);
+
+        std::cout << "[TT] Taint pre-pass: " << std::dec << relevant.size() << " of " << vars.size() << " input variables reach an address or the control flow" << std::endl;
+      }
+
+
+      bool SymbolicExplorator::expandInput(const Seed& seed) {
+        std::vector<triton::usize> vars(this->dormant.begin(), this->dormant.end());
+
+        auto relevant = this->taintRelevant(seed, vars);
+        for (const auto& id : relevant) {
+          const auto& entry = this->layout[id];
+          for (triton::uint32 i = 0; i < entry.size; i++) {
+            triton::uint64 addr = entry.var->getOrigin() + i;
+            auto it = this->dormantMem.find(addr);
+            if (it != this->dormantMem.end()) {
+              this->bck_ctx->assignSymbolicExpressionToMemory(it->second, triton::arch::MemoryAccess(addr, triton::size::byte));
+              this->dormantMem.erase(it);
+            }
+          }
+          this->dormant.erase(id);
+        }
+
+        if (relevant.size()) {
+          this->snapshotContext(this->ini_ctx, this->bck_ctx);
+          std::cout << "[TT] Taint: " << std::dec << relevant.size() << " input variables symbolized again, " << this->dormant.size() << " remain concrete" << std::endl;
+        }
+
+        return relevant.size() != 0;
+      }
+
+
+      bool SymbolicExplorator::mutationStage(void) {
+        triton::usize pending = this->worklist.size();
+
+        if (this->corpus.size() == 0) {
+          return false;
+        }
+
+        this->mode = MODE_CONCRETE;
+        this->ini_ctx->enableSymbolicEngine(false);
+
+        for (triton::usize i = 0; i < this->config.mutation_rounds; i++) {
+          const auto& parent = this->corpus[this->mutator.pick(this->corpus.size())];
+          const auto& other  = this->corpus[this->mutator.pick(this->corpus.size())];
+          Seed mutant(this->mutator.mutate(*parent, *other));
+          triton::usize icov = this->coverage.size();
+
+          this->nbmutant++;
+          this->injectSeed(mutant);
+          this->run(mutant);
+          this->snapshotContext(this->ini_ctx, this->bck_ctx);
+
+          /* New coverage, give the mutant to the solver */
+          if (this->coverage.size() > icov) {
+            this->nbmutcov++;
+            this->corpus.push_back(this->current);
+            this->worklist.push_back(mutant, this->runPriority);
+          }
+        }
+
+        this->ini_ctx->enableSymbolicEngine(true);
+        this->mode = MODE_SYMBOLIC;
+
+        if (this->config.stats) {
+          this->printStat();
+        }
+
+        return this->worklist.size() > pending;
+      }
+
+
       void SymbolicExplorator::printStat(void) {
         std::cout << "[TT] exec: " << std::dec << this->nbexec
                   << ",  icov: " << this->coverage.size()
                   << ",  sat: " << this->nbsat
                   << ",  unsat: " << this->nbunsat
                   << ",  timeout: " << this->nbtimeout
+                  << ",  i2s: " << this->nbi2s
+                  << ",  presolved: " << this->nbpresolve
+                  << ",  hinted: " << this->nbhint
+                  << ",  dup: " << this->nbdup
+                  << ",  skip: " << this->nbskip
+                  << ",  deprio: " << this->nbdeprio
+                  << ",  mutants: " << this->nbmutant
+                  << ",  mutcov: " << this->nbmutcov
+                  << ",  hangs: " << this->nbhang
+                  << ",  crashes: " << this->nbcrash
+                  << ",  buckets: " << this->crashes.size()
                   << ",  worklist: " << this->worklist.size()
+                  << ",  spilled: " << this->worklist.spilled()
                   << std::endl;
       }
 
 
       void SymbolicExplorator::hookInstruction(triton::uint64 addr, instCallback fn) {
-        this->instHooks.insert(std::pair<triton::uint64, instCallback>(addr, fn));
+        this->hooks.addInstruction(addr, fn);
+      }
+
+
+      void SymbolicExplorator::hookRange(triton::uint64 lo, triton::uint64 hi, instCallback fn) {
+        this->hooks.addRange(lo, hi, fn);
+      }
+
+
+      void SymbolicExplorator::hookMemoryRead(triton::uint64 lo, triton::uint64 hi, memReadCallback fn) {
+        this->hooks.addMemoryRead(lo, hi, fn);
+      }
+
+
+      void SymbolicExplorator::hookMemoryWrite(triton::uint64 lo, triton::uint64 hi, memWriteCallback fn) {
+        this->hooks.addMemoryWrite(lo, hi, fn);
       }
 
 
@@ -382,40 +1594,97 @@ namespace triton {
           throw triton::exceptions::Engines("SymbolicExplorator::explore(): The initial context cannot be null.");
         }
 
-        /* Alocate and init a backup context */
-        this->bck_ctx = new triton::Context(this->ini_ctx->getArchitecture());
-        this->snapshotContext(this->bck_ctx, this->ini_ctx);
+        /* Without a covered policy no target is ever covered, nothing would be deprioritized */
+        if (this->config.deprioritize_covered && this->config.skip_covered == COVER_NONE) {
+          throw triton::exceptions::Engines("SymbolicExplorator::explore(): deprioritize_covered requires skip_covered to be COVER_INST or COVER_EDGE.");
+        }
+
+        this->initState();
+
+        /* Only keep symbolic the input bytes that matter for the initial seed */
+        if (this->config.taint_prepass) {
+          this->shrinkInput(Seed(this->current, {}));
+        }
 
         this->initWorklist();
-        while (this->worklist.size()) {
-          /* Pickup a seed */
-          auto seed = *(this->worklist.begin());
+
+        /* Progress of the solver since the last mutation stage */
+        triton::usize stallSolved = 0;
+        triton::usize stallTimeout = 0;
+
+        while (this->worklist.size() || (this->config.mutation && this->mutationStage())) {
+          /* The solver only times out, let the mutation stage find other paths */
+          if (this->config.mutation && this->nbtimeout - stallTimeout >= this->config.mutation_timeouts) {
+            if (this->nbsat + this->nbunsat == stallSolved) {
+              this->mutationStage();
+            }
+            stallSolved = this->nbsat + this->nbunsat;
+            stallTimeout = this->nbtimeout;
+          }
+
           if (this->config.stats) {
             this->printStat();
           }
 
-          /* Remove the seed from the worklist */
-          this->worklist.erase(this->worklist.begin());
+          /* Pickup a seed and remove it from the worklist */
+          auto item = this->worklist.pop();
+
+          /* Solve the query if its solving has been deferred */
+          if (item.query != nullptr && this->solveQuery(item.query, item.seed) == false) {
+            continue;
+          }
+          const auto& seed = item.seed;
 
           /* Inject seed into the context */
           this->injectSeed(seed);
 
           /* Execute the target */
+          triton::usize icov = this->coverage.size();
           this->run(seed);
+          triton::usize prio = this->runPriority;
+
+          /* Keep seeds that reach new coverage as mutation inputs */
+          if (this->config.mutation && this->coverage.size() > icov) {
+            this->corpus.push_back(this->current);
+          }
 
-          /* Generate new seeds */
-          this->findNewInputs();
+          /* Update the distances before prioritizing the new seeds */
+          if (this->config.targets.size()) {
+            this->cfg.computeDistances(this->config.targets);
+            this->checkTargets();
+          }
+
+          /* Generate new seeds, unless the same path has already been expanded (its branches are all in the donelist) */
+          if (this->paths.insert(this->pathHash).second) {
+            this->findNewInputs();
+          }
+          else {
+            this->nbdup++;
+          }
 
           /* Restore initial context */
           this->snapshotContext(this->ini_ctx, this->bck_ctx);
+
+          /* New coverage may depend on concretized bytes, execute the seed again if some matter now */
+          if (this->dormant.size() && this->coverage.size() > icov && this->expandInput(seed)) {
+            this->worklist.push_front(seed, prio);
+          }
         }
 
         /* Last stats */
         if (this->config.stats) {
           this->printStat();
+          this->printCrashes();
+        }
+
+        if (this->config.solver_profile) {
+          this->writeSolverProfile();
         }
 
         /* Delete the allocated backup context */
+        if (this->loader) {
+          this->loader->setBackup(nullptr);
+        }
         delete this->bck_ctx;
       }
 
@@ -10,8 +10,11 @@
 
 #include <list>
 #include <map>
+#include <memory>
+#include <set>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <triton/comparableFunctor.hpp>
@@ -21,6 +24,15 @@
 #include <triton/solverModel.hpp>
 #include <triton/tritonTypes.hpp>
 
+#include <cfg.hpp>
+#include <hooks.hpp>
+#include <loader.hpp>
+#include <mutator.hpp>
+#include <recorder.hpp>
+#include <seed.hpp>
+#include <timeline.hpp>
+#include <trace.hpp>
+#include <worklist.hpp>
 
 
 //! The Triton namespace
@@ -30,23 +42,6 @@ namespace triton {
  *  @{
  */
 
-  //! The Callbacks namespace
-  namespace callbacks {
-  /*!
-   *  \ingroup triton
-   *  \addtogroup callbacks
-   *  @{
-   */
-
-    //! State of callback
-    enum cb_state_e {
-      CONTINUE,
-      BREAK,
-      PLT_CONTINUE,
-    };
-
-  };
-
   //! The Engines namespace
   namespace engines {
   /*!
@@ -63,23 +58,100 @@ namespace triton {
      *  @{
      */
 
-      //! Shortcut for a seed.
-      using Seed = std::unordered_map<triton::usize, triton::engines::solver::SolverModel>;
+      //! Shortcut for a model returned by the solver.
+      using Model = std::unordered_map<triton::usize, triton::engines::solver::SolverModel>;
+
+      //! Execution mode of a trace.
+      enum mode_e {
+        MODE_SYMBOLIC, /* symbolic execution, new inputs are generated from the trace */
+        MODE_CONCRETE, /* concrete execution only, the symbolic engine is disabled */
+        MODE_TAINT,    /* taint execution only, looks for input bytes reaching addresses or the control flow */
+      };
+
+      //! Location of a symbolic variable into the bytes of a seed.
+      struct layout_s {
+        triton::engines::symbolic::SharedSymbolicVariable var;
+        triton::uint32 offset;
+        triton::uint32 size; /* bytes */
+      };
+
+      //! How the target of a flip is considered as covered.
+      enum cover_e {
+        COVER_NONE, /* never, every flip is solved */
+        COVER_INST, /* the target instruction has been executed */
+        COVER_EDGE, /* the edge from the branch to the target has been taken */
+      };
+
+      //! Value of `hang_inst` or `hang_time` that disables the limit.
+      const triton::usize HANG_OFF = static_cast<triton::usize>(-1);
+
+      //! Origin of a solver query.
+      enum origin_e {
+        ORIGIN_INIT, /* initial path predicate */
+        ORIGIN_FLIP, /* flip of a conditional branch */
+        ORIGIN_EA,   /* symbolic load or store */
+        ORIGIN_JMP,  /* target of an indirect jump */
+      };
+
+      //! Solver statistics of a query site.
+      struct site_s {
+        triton::usize calls;
+        triton::usize sat;
+        triton::usize unsat;
+        triton::usize timeout;
+        triton::usize total; /* milliseconds */
+        triton::usize max;   /* milliseconds */
+        triton::usize nodes; /* sum of the AST sizes */
+      };
+
+      //! A concretized effective address, kept apart from the branch constraints.
+      struct pin_s {
+        triton::ast::SharedAbstractNode ea;         /* the effective address */
+        triton::ast::SharedAbstractNode constraint; /* ea == its concrete value */
+        std::set<triton::usize> vars;               /* variables of the effective address */
+        triton::usize index;                        /* number of path constraints when pinned */
+      };
+
+      //! A crash bucket.
+      struct crash_s {
+        std::string    reason;  /* why the execution crashed */
+        triton::uint64 pc;      /* faulting program counter */
+        triton::usize  hits;    /* number of executions that fell into the bucket */
+        triton::usize  weight;  /* number of non-null bytes of the representative seed */
+      };
 
       //! Config of the exploration.
       struct config_s {
+        bool            lazy_solving;
         bool            stats;
         std::string     workspace = "workspace";
         triton::uint64  end_point;
+        triton::usize   crash_trail;
+        bool            input_to_state;
+        bool            presolve;
+        bool            model_hints;
+        bool            mutation;
+        triton::usize   mutation_rounds;
+        triton::usize   mutation_timeouts;
         triton::usize   ea_model;
+        triton::usize   hang_factor;
+        triton::usize   hang_inst;
+        triton::usize   hang_time; /* milliseconds */
         triton::usize   jmp_model;
         triton::usize   limit_inst;
         triton::usize   timeout; /* seconds */
+        bool            taint_prepass;
+        bool            record_queries;
+        bool            solver_profile;
+        cover_e         skip_covered;
+        bool            deprioritize_covered;
+        std::vector<triton::uint64> targets;
+        triton::usize   worklist_budget; /* megabytes */
+        bool            coverage_timeline;
+        bool            trace;
+        triton::usize   trace_size; /* kilobytes */
       };
 
-      //! Instruction callback signature
-      using instCallback = triton::ComparableFunctor<triton::callbacks::cb_state_e(triton::Context*)>;
-
       /*! \class SymbolicExplorator
           \brief The symbolic explorator class. */
       class SymbolicExplorator {
@@ -87,20 +159,95 @@ namespace triton {
           //! Execute one trace.
           void run(const Seed& seed);
 
+          //! Execute one trace, specialized for an architecture.
+          template <typename Arch> void run(const Seed& seed);
+
+          //! Allocate the backup context and the layout before an exploration or a replay.
+          void initState(void);
+
           //! Init the worklist.
           void initWorklist(void);
 
           //! Snaptshot context from src to dst.
           void snapshotContext(triton::Context* dst, triton::Context* src);
 
+          //! Snaptshot context from src to dst, specialized for an architecture.
+          template <typename Arch> void snapshotContext(triton::Context* dst, triton::Context* src);
+
           //! Find new inputs and update the path tree.
           void findNewInputs(void);
 
+          //! Compute the layout of symbolic variables into seeds.
+          void initLayout(void);
+
+          //! Convert a model into a seed stored as a diff against the current seed.
+          Seed model2seed(const Model& model);
+
+          //! Convert a model into a seed stored as a diff against the given parent.
+          Seed model2seed(const Model& model, const std::shared_ptr<const SeedBytes>& parent);
+
+          //! Ask the solver for a model. Every query goes through this method.
+          Model getModel(const triton::ast::SharedAbstractNode& node, origin_e origin, triton::uint64 addr, triton::engines::solver::status_e* status);
+
+          //! Ask the solver for several models. Every query goes through this method.
+          std::vector<Model> getModels(const triton::ast::SharedAbstractNode& node, triton::usize limit, origin_e origin, triton::uint64 addr, triton::engines::solver::status_e* status);
+
+          //! Returns the value of a variable in a seed.
+          triton::uint512 seedValue(const triton::engines::symbolic::SharedSymbolicVariable& var, const std::shared_ptr<const SeedBytes>& seed);
+
+          //! Ask the solver for a flip model that keeps the parent values of the variables the branch does not constrain. Falls back to the plain query if the hinted one is unsat.
+          Model getHintedModel(const triton::ast::SharedAbstractNode& node, const triton::ast::SharedAbstractNode& branch, const std::shared_ptr<const SeedBytes>& parent, triton::uint64 addr, triton::engines::solver::status_e* status);
+
+          //! Settle a query without the solver, variables not forced keep the value they have in the parent. Returns UNKNOWN if the solver is needed.
+          triton::engines::solver::status_e presolveQuery(const triton::ast::SharedAbstractNode& node, const std::shared_ptr<const SeedBytes>& parent, Model& model);
+
+          //! Account a solver query to its site.
+          void profileQuery(const triton::ast::SharedAbstractNode& node, origin_e origin, triton::uint64 addr, triton::engines::solver::status_e status, triton::usize ms);
+
+          //! Append a solver query to the query file.
+          void recordQuery(const triton::ast::SharedAbstractNode& node, origin_e origin, triton::uint64 addr, triton::engines::solver::status_e status, triton::usize ms, triton::usize limit);
+
+          //! Write the solver profile into the workspace, sorted by total solving time.
+          void writeSolverProfile(void);
+
+          //! Returns the priority of a seed that aims the given address, its distance to the targets in directed mode.
+          triton::usize priority(triton::uint64 addr);
+
+          //! Report the targets reached for the first time.
+          void checkTargets(void);
+
+          //! Returns true if the target of a flip is covered according to the given policy.
+          bool isCovered(triton::uint64 src, triton::uint64 dst, cover_e policy);
+
+          //! Solve a pending query. Returns false if the query is skipped or has no model.
+          bool solveQuery(const std::shared_ptr<query_s>& query, Seed& seed);
+
           //! Inject a seed into the state.
           void injectSeed(const Seed& seed);
 
+          //! Write the bytes of a variable into the machine state at its origin, without touching the variable.
+          void writeVariable(const layout_s& entry, const SeedBytes& bytes);
+
+          //! Returns true if an address computed by the instruction depends on tainted registers.
+          bool isTaintedAddress(triton::arch::Instruction& inst);
+
+          //! Execute a seed with the given variables tainted. Returns true if the taint reaches an address or the control flow.
+          bool taintRun(const Seed& seed, const std::vector<triton::usize>& vars);
+
+          //! Returns the variables among `vars` that reach an address or the control flow when `seed` is executed.
+          std::set<triton::usize> taintRelevant(const Seed& seed, const std::vector<triton::usize>& vars);
+
+          //! Concretize the input bytes that do not matter for the given seed.
+          void shrinkInput(const Seed& seed);
+
+          //! Symbolize again the concretized input bytes that matter for the given seed. Returns true if the input grew.
+          bool expandInput(const Seed& seed);
+
+          //! Run mutants of the corpus concretely. Returns true if new seeds have been pushed into the worklist.
+          bool mutationStage(void);
+
           //! Pretty print a seed.
-          std::stringstream seedRepr(void);
+          std::stringstream seedRepr(const Seed& seed);
 
           //! Print stats at each execution
           void printStat(void);
@@ -111,15 +258,42 @@ namespace triton {
           //! Build the path encoding
           std::list<triton::uint64> buildPathAddrs(void);
 
+          //! Pin an effective address to its concrete value, unless it is already determined by earlier pins.
+          void pinEffectiveAddress(const triton::ast::SharedAbstractNode& ea);
+
+          //! Returns true if the value of a node is determined by the pins.
+          bool isPinned(const triton::ast::SharedAbstractNode& node, std::unordered_map<const triton::ast::AbstractNode*, bool>& memo);
+
+          //! Collect the pins made before `upto` path constraints that share variables with `vars`, transitively. `fresh` are the variables to start from, pins marked in `used` are skipped.
+          void collectPins(std::set<triton::usize>& vars, std::vector<triton::usize> fresh, triton::usize upto, std::vector<bool>& used, std::vector<triton::ast::SharedAbstractNode>& nodes);
+
           //! Convert a seed to a vector.
           std::vector<triton::uint8> seed2vector(const Seed& seed);
 
+          //! Convert a vector to a seed. The vector is truncated or padded with zeros to the layout size.
+          Seed vector2seed(const std::vector<triton::uint8>& v);
+
           //! Write the seed into the given directory
           void writeSeedOnDisk(const std::string& dir, const Seed& seed);
 
+          //! Write the seed into the given directory with the given file name
+          void writeSeedOnDisk(const std::string& dir, const Seed& seed, const std::string& name);
+
+          //! Bucket a crash by its faulting pc and the trail of recent branches
+          void triageCrash(const Seed& seed, const std::string& reason, triton::uint64 pc, const std::vector<triton::uint64>& trail, triton::usize trailIdx);
+
+          //! Print the crash buckets
+          void printCrashes(void);
+
+          //! Record the length of a completed execution and adapt the watchdog limits
+          void updateWatchdog(triton::usize count, triton::usize ms);
+
           //! Execute a ret instruction according to the architecture
           void asmret(void);
 
+          //! Execute a ret instruction, specialized for an architecture.
+          template <typename Arch> void asmret(void);
+
         protected:
           //! Number of executions
           triton::usize nbexec;
@@ -133,6 +307,90 @@ namespace triton {
           //! Number of timeout
           triton::usize nbtimeout;
 
+          //! Number of pending queries skipped because their target got covered
+          triton::usize nbskip;
+
+          //! Number of flips pushed at the back of the worklist because their target is covered
+          triton::usize nbdeprio;
+
+          //! Number of flips solved by input-to-state
+          triton::usize nbi2s;
+
+          //! Number of flips settled by the presolver
+          triton::usize nbpresolve;
+
+          //! Number of flips solved with the parent values as hints
+          triton::usize nbhint;
+
+          //! Number of symbolic executions whose path had already been expanded
+          triton::usize nbdup;
+
+          //! Number of crashes
+          triton::usize nbcrash;
+
+          //! Number of mutants executed
+          triton::usize nbmutant;
+
+          //! Number of mutants that reached new coverage
+          triton::usize nbmutcov;
+
+          //! Execution mode of the current trace
+          mode_e mode;
+
+          //! Mutation engine
+          Mutator mutator;
+
+          //! Seeds that reached new coverage, used as mutation inputs
+          std::vector<std::shared_ptr<const SeedBytes>> corpus;
+
+          //! Number of variables bound to jump targets
+          triton::usize nbjmpvar;
+
+          //! Number of executions stopped by the watchdog
+          triton::usize nbhang;
+
+          //! Instruction counts of recent executions
+          std::vector<triton::usize> execInsts;
+
+          //! Wall-clock times (ms) of recent executions, solver time excluded
+          std::vector<triton::usize> execTimes;
+
+          //! Number of executions recorded by the watchdog
+          triton::usize execSamples;
+
+          //! Adaptive instruction limit per execution
+          triton::usize watchdogInst;
+
+          //! Adaptive wall-clock limit (ms) per execution
+          triton::usize watchdogTime;
+
+          //! Time (ms) spent in the solver, subtracted from the length of executions
+          triton::usize solverTime;
+
+          //! Set by taint runs when the taint reaches an address or the control flow
+          bool taintHit;
+
+          //! Variables concretized by the taint pre-pass
+          std::set<triton::usize> dormant;
+
+          //! Symbolic expressions of the concretized input bytes <addr : expr>
+          std::unordered_map<triton::uint64, triton::engines::symbolic::SharedSymbolicExpression> dormantMem;
+
+          //! Solver statistics per site <<addr, origin> : stats>
+          std::map<std::pair<triton::uint64, origin_e>, site_s> sites;
+
+          //! Recorder of solver queries
+          QueryRecorder recorder;
+
+          //! Recorder of the executed instructions
+          TraceRecorder tracer;
+
+          //! Log and exports of the coverage as it grows
+          CoverageTimeline timeline;
+
+          //! Crash buckets <bucket hash : crash>
+          std::map<triton::uint64, crash_s> crashes;
+
           //! Initial context.
           triton::Context* ini_ctx;
 
@@ -140,16 +398,64 @@ namespace triton {
           triton::Context* bck_ctx;
 
           //! Worklist.
-          std::list<Seed> worklist;
+          Worklist worklist;
+
+          //! Control flow graph of directed exploration
+          Cfg cfg;
+
+          //! Targets reached by directed exploration
+          std::set<triton::uint64> reached;
+
+          //! Layout of symbolic variables indexed by variable id.
+          std::vector<layout_s> layout;
+
+          //! Size of seeds according to the layout.
+          triton::usize layoutSize;
+
+          //! Bytes of the seed currently executed. Children are stored as a diff against it.
+          std::shared_ptr<const SeedBytes> current;
+
+          //! Bytes currently injected into the symbolic variables.
+          SeedBytes injected;
+
+          //! Bytes held by the machine state of the backup context.
+          SeedBytes initial;
 
           //! Donelist
           std::set<std::list<triton::uint64>> donelist;
 
+          //! Targets produced for an indirect jump, keyed by the path up to the jump (its address included)
+          std::map<std::list<triton::uint64>, std::shared_ptr<std::set<triton::uint64>>> jumpTargets;
+
+          //! Effective addresses pinned during the current execution, in order
+          std::vector<pin_s> pins;
+
+          //! Pins by hash of their effective address
+          std::map<triton::uint512, triton::usize> pinsByHash;
+
+          //! Pins by variable <var id : pin indexes>
+          std::unordered_map<triton::usize, std::vector<triton::usize>> pinsByVar;
+
           //! The coverage map <inst addr: number of hits>
           std::unordered_map<triton::uint64, triton::usize> coverage;
 
-          //! Hook instructions: <plt addr : cb>
-          std::map<triton::uint64, instCallback> instHooks;
+          //! The edges taken <hash of src and dst>
+          std::unordered_set<triton::uint64> edges;
+
+          //! Hash of the symbolic branches taken by the last execution
+          triton::uint64 pathHash;
+
+          //! Priority of the last execution, the distance of the nearest branch destination it reached in directed mode
+          triton::usize runPriority;
+
+          //! Hashes of the paths already expanded by findNewInputs()
+          std::unordered_set<triton::uint64> paths;
+
+          //! Instruction, range and memory hooks
+          HookTable hooks;
+
+          //! Loader mapping the memory lazily, if any
+          triton::loaders::LazyLoader* loader;
 
         public:
           struct config_s config;
@@ -166,14 +472,29 @@ namespace triton {
           //! Init context.
           TRITON_EXPORT void initContext(triton::Context* ctx);
 
+          //! Init the loader that lazily maps the memory into the context.
+          TRITON_EXPORT void initLoader(triton::loaders::LazyLoader* loader);
+
           //! Explore the program.
           TRITON_EXPORT void explore(void);
 
+          //! Execute concretely every file of a corpus directory, merge and dump the coverage.
+          TRITON_EXPORT void replay(const std::string& dir);
+
           //! Dump the code coverage
           TRITON_EXPORT void dumpCoverage(void);
 
           //! Add callback
           TRITON_EXPORT void hookInstruction(triton::uint64 addr, instCallback fn);
+
+          //! Add callback on every instruction of [lo, hi)
+          TRITON_EXPORT void hookRange(triton::uint64 lo, triton::uint64 hi, instCallback fn);
+
+          //! Add callback on memory reads overlapping [lo, hi)
+          TRITON_EXPORT void hookMemoryRead(triton::uint64 lo, triton::uint64 hi, memReadCallback fn);
+
+          //! Add callback on memory writes overlapping [lo, hi)
+          TRITON_EXPORT void hookMemoryWrite(triton::uint64 lo, triton::uint64 hi, memWriteCallback fn);
       };
 
     /*! @} End of exploration namespace */
@@ -0,0 +1,230 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <triton/exceptions.hpp>
+
+#include <worklist.hpp>
+
+
+
+namespace triton {
+  namespace engines {
+    namespace exploration {
+
+      Worklist::Worklist() {
+        this->budget = 0;
+        this->count = 0;
+        this->memory = 0;
+        this->nbsegments = 0;
+        this->nbspilled = 0;
+      }
+
+
+      Worklist::~Worklist() {
+        for (const auto& item : this->buckets) {
+          for (const auto& entry : item.second.entries) {
+            if (entry.spill != nullptr) {
+              std::remove(entry.spill->path.c_str());
+            }
+          }
+        }
+      }
+
+
+      void Worklist::setBudget(triton::usize budget, const std::string& dir) {
+        this->budget = budget;
+        this->dir = dir;
+      }
+
+
+      triton::usize Worklist::footprint(const work_s& item) {
+        if (item.query != nullptr) {
+          return sizeof(work_s) + sizeof(query_s) + (item.query->targets ? item.query->targets->size() : 0) * sizeof(triton::uint64);
+        }
+        if (item.spill != nullptr) {
+          return sizeof(work_s) + sizeof(spill_s) + item.spill->path.size();
+        }
+        return sizeof(work_s) + item.seed.footprint();
+      }
+
+
+      void Worklist::acquire(const work_s& item) {
+        const SeedBytes* parent = (item.query != nullptr) ? item.query->parent.get() : item.seed.parent();
+        this->memory += this->footprint(item);
+        if (parent && this->parents[parent]++ == 0) {
+          this->memory += parent->size();
+        }
+      }
+
+
+      void Worklist::release(const work_s& item) {
+        const SeedBytes* parent = (item.query != nullptr) ? item.query->parent.get() : item.seed.parent();
+        this->memory -= this->footprint(item);
+        if (parent) {
+          auto it = this->parents.find(parent);
+          if (--it->second == 0) {
+            this->memory -= parent->size();
+            this->parents.erase(it);
+          }
+        }
+      }
+
+
+      void Worklist::push_front(work_s item, triton::usize prio) {
+        this->acquire(item);
+        this->buckets[prio].entries.push_front(std::move(item));
+        this->count++;
+        if (this->budget && this->memory > this->budget) {
+          this->spill();
+        }
+      }
+
+
+      void Worklist::push_back(work_s item, triton::usize prio) {
+        this->acquire(item);
+        this->buckets[prio].entries.push_back(std::move(item));
+        this->count++;
+        if (this->budget && this->memory > this->budget) {
+          this->spill();
+        }
+      }
+
+
+      std::shared_ptr<spill_s> Worklist::writeSegment(const std::vector<Seed>& batch) {
+        auto segment = std::make_shared<spill_s>();
+        segment->path = this->dir + "/" + std::to_string(this->nbsegments++) + ".seg";
+        segment->size = batch.size();
+
+        /* Segment format: count (u32), then for each seed its size (u32) and its bytes, front to back */
+        std::ofstream f(segment->path, std::ios::binary);
+        triton::uint32 n = static_cast<triton::uint32>(batch.size());
+        f.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        SeedBytes bytes;
+        for (const auto& seed : batch) {
+          seed.materialize(bytes);
+          triton::uint32 size = static_cast<triton::uint32>(bytes.size());
+          f.write(reinterpret_cast<const char*>(&size), sizeof(size));
+          f.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+        f.close();
+        if (f.fail()) {
+          throw triton::exceptions::Engines("Worklist::writeSegment(): Cannot write " + segment->path);
+        }
+
+        this->nbspilled += batch.size();
+        return segment;
+      }
+
+
+      void Worklist::spill(void) {
+        triton::usize target = this->budget / 4 * 3;
+
+        for (auto bit = this->buckets.rbegin(); bit != this->buckets.rend() && this->memory > target; bit++) {
+          auto& entries = bit->second.entries;
+
+          /* Seeds at the back are the last ones to be popped, each run of seeds ends before `it` */
+          auto it = entries.end();
+          while (it != entries.begin() && this->memory > target) {
+            auto last = it;
+            while (it != entries.begin() && this->memory > target) {
+              auto prev = std::prev(it);
+              if (prev->query != nullptr || prev->spill != nullptr)
+                break;
+              it = prev;
+              this->release(*it);
+            }
+
+            /* Queries and placeholders stay where they are */
+            if (it == last) {
+              it--;
+              continue;
+            }
+
+            std::vector<Seed> batch;
+            for (auto run = it; run != last; run++) {
+              batch.push_back(std::move(run->seed));
+            }
+            it = entries.erase(it, last);
+            it = entries.insert(it, work_s(this->writeSegment(batch)));
+            this->acquire(*it);
+          }
+        }
+      }
+
+
+      void Worklist::pageIn(bucket_s& bucket) {
+        auto placeholder = bucket.entries.begin();
+        auto segment = placeholder->spill;
+        this->release(*placeholder);
+        bucket.entries.erase(placeholder);
+
+        std::ifstream f(segment->path, std::ios::binary);
+        triton::uint32 n = 0;
+        f.read(reinterpret_cast<char*>(&n), sizeof(n));
+        if (f.fail() || n != segment->size) {
+          throw triton::exceptions::Engines("Worklist::pageIn(): Cannot read " + segment->path);
+        }
+
+        /* Seeds take the position of the placeholder */
+        auto pos = bucket.entries.begin();
+        for (triton::uint32 i = 0; i < n; i++) {
+          triton::uint32 size = 0;
+          f.read(reinterpret_cast<char*>(&size), sizeof(size));
+          SeedBytes bytes(size);
+          f.read(reinterpret_cast<char*>(bytes.data()), size);
+          if (f.fail()) {
+            throw triton::exceptions::Engines("Worklist::pageIn(): Truncated segment " + segment->path);
+          }
+          work_s item(Seed(std::move(bytes)));
+          this->acquire(item);
+          bucket.entries.insert(pos, std::move(item));
+        }
+
+        f.close();
+        std::remove(segment->path.c_str());
+        this->nbspilled -= n;
+      }
+
+
+      work_s Worklist::pop(void) {
+        if (this->count == 0) {
+          throw triton::exceptions::Engines("Worklist::pop(): The worklist is empty.");
+        }
+
+        auto it = this->buckets.begin();
+        auto& bucket = it->second;
+        while (bucket.entries.front().spill != nullptr) {
+          this->pageIn(bucket);
+        }
+
+        auto item = std::move(bucket.entries.front());
+        bucket.entries.pop_front();
+        if (bucket.entries.empty()) {
+          this->buckets.erase(it);
+        }
+        this->release(item);
+        this->count--;
+
+        return item;
+      }
+
+
+      triton::usize Worklist::size(void) const {
+        return this->count;
+      }
+
+
+      triton::usize Worklist::spilled(void) const {
+        return this->nbspilled;
+      }
+
+    }; /* exploration namespace */
+  }; /* engines namespace */
+}; /*triton namespace */
@@ -0,0 +1,188 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+#ifndef TRITON_WORKLIST_H
+#define TRITON_WORKLIST_H
+
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <triton/ast.hpp>
+#include <triton/dllexport.hpp>
+#include <triton/symbolicVariable.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include <seed.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Kind of pending query.
+      enum query_e {
+        QUERY_FLIP, /* flip of a conditional branch */
+        QUERY_JMP,  /* enumeration of the targets of an indirect jump */
+      };
+
+      //! A query whose solving is deferred until it is picked from the worklist.
+      struct query_s {
+        query_e kind;
+        triton::ast::SharedAbstractNode constraint; /* path prefix && branch constraint */
+        triton::ast::SharedAbstractNode branch;     /* branch constraint alone */
+        triton::uint64 src;                         /* address of the branch */
+        triton::uint64 dst;                         /* address targeted by the query */
+        std::shared_ptr<const SeedBytes> parent;    /* bytes of the seed that discovered the query */
+        bool deprioritized = false;                 /* the target was already covered at discovery */
+
+        /* Indirect jumps only */
+        triton::engines::symbolic::SharedSymbolicVariable target; /* variable bound to the jump target */
+        std::shared_ptr<std::set<triton::uint64>> targets;        /* targets already produced, shared by the jump site */
+      };
+
+      //! A segment file of spilled seeds.
+      struct spill_s {
+        std::string path;   /* segment file */
+        triton::usize size; /* number of seeds */
+      };
+
+      //! An entry of the worklist, either a concrete seed, a pending query or spilled seeds.
+      struct work_s {
+        Seed seed;
+        std::shared_ptr<query_s> query;
+        std::shared_ptr<spill_s> spill; /* placeholder of seeds spilled at this position, internal to the worklist */
+
+        work_s(Seed seed) : seed(std::move(seed)) {}
+        work_s(std::shared_ptr<query_s> query) : query(std::move(query)) {}
+        work_s(std::shared_ptr<spill_s> spill) : spill(std::move(spill)) {}
+      };
+
+      //! Entries of a priority.
+      struct bucket_s {
+        std::list<work_s> entries; /* entries in memory and placeholders of spilled ones */
+      };
+
+      /*! \class Worklist
+          \brief The worklist of the explorator.
+
+          \details Entries are grouped by priority, the lower the sooner. Inside a priority,
+          entries are ordered as in a list, pushing at the front gives a depth-first order.
+          Without directed exploration, every entry has the priority 0.
+
+          When a memory budget is set and exceeded, concrete seeds are spilled from the back
+          of the highest priorities (the ones popped last) into segment files, until the
+          memory drops under 3/4 of the budget. Each run of consecutive seeds is replaced by
+          a placeholder, and the segment is paged in at that position when the placeholder
+          reaches the front, so spilling never changes the order of the entries. Pending
+          queries hold ASTs and are never spilled.
+
+          The memory of an entry is its own bytes plus, once for all the entries sharing
+          it, the bytes of the parent seed. The ASTs of pending queries are shared with
+          the path constraints of the explorator and are not counted. */
+      class Worklist {
+        private:
+          //! Entries by priority.
+          std::map<triton::usize, bucket_s> buckets;
+
+          //! Number of entries.
+          triton::usize count;
+
+          //! Number of entries spilled on disk.
+          triton::usize nbspilled;
+
+          //! Estimated memory of the entries in memory (bytes).
+          triton::usize memory;
+
+          //! Parent bytes shared by entries in memory <bytes : number of entries>.
+          std::unordered_map<const SeedBytes*, triton::usize> parents;
+
+          //! Memory budget (bytes), 0 for no budget.
+          triton::usize budget;
+
+          //! Directory of the segment files.
+          std::string dir;
+
+          //! Number of segment files written.
+          triton::usize nbsegments;
+
+          //! Returns the estimated memory of an entry, shared parent excluded.
+          static triton::usize footprint(const work_s& item);
+
+          //! Account an entry entering the memory.
+          void acquire(const work_s& item);
+
+          //! Account an entry leaving the memory.
+          void release(const work_s& item);
+
+          //! Spill cold seeds until the memory drops under 3/4 of the budget.
+          void spill(void);
+
+          //! Write a run of seeds, front to back, into a new segment file.
+          std::shared_ptr<spill_s> writeSegment(const std::vector<Seed>& batch);
+
+          //! Page in the segment of the placeholder at the front of a bucket.
+          void pageIn(bucket_s& bucket);
+
+        public:
+          //! Constructor.
+          TRITON_EXPORT Worklist();
+
+          //! Destructor, remove the remaining segment files.
+          TRITON_EXPORT ~Worklist();
+
+          //! Set the memory budget (bytes) and the directory of the segment files.
+          TRITON_EXPORT void setBudget(triton::usize budget, const std::string& dir);
+
+          //! Push an entry at the front of its priority.
+          TRITON_EXPORT void push_front(work_s item, triton::usize prio = 0);
+
+          //! Push an entry at the back of its priority.
+          TRITON_EXPORT void push_back(work_s item, triton::usize prio = 0);
+
+          //! Pop the first entry of the lowest priority.
+          TRITON_EXPORT work_s pop(void);
+
+          //! Returns the number of entries.
+          TRITON_EXPORT triton::usize size(void) const;
+
+          //! Returns the number of entries spilled on disk.
+          TRITON_EXPORT triton::usize spilled(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_WORKLIST_H */
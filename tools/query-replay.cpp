@@ -0,0 +1,216 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+/*
+ * Replay a query file recorded by the explorator (config.record_queries) against
+ * an external solver, and report the latency distribution.
+ *
+ *   $ ./query-replay workspace/queries.ttq -j 8 -- z3 -T:60
+ *   $ ./query-replay workspace/queries.ttq -j 8 -- bitwuzla --time-limit=60000
+ *
+ * The solver command gets the path of a SMT-LIB2 script as last argument. The
+ * timeout recorded with a query is applied with (set-option :timeout <ms>).
+ *
+ * Queries recorded from an enumeration of models (limit > 1) carry the latency of
+ * the whole enumeration while the replay only checks the first model. They are
+ * reported apart and left out of the recorded and replayed distributions.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <triton/solverEnums.hpp>
+
+#include <recorder.hpp>
+
+
+using triton::engines::exploration::QueryRecorder;
+using triton::engines::exploration::record_s;
+
+static const char* origins[] = {"init", "flip", "ea", "jmp"};
+
+
+struct replay_s {
+  record_s header;
+  std::string smt;
+  std::string result;  /* first line printed by the solver */
+  triton::usize ms;    /* replay latency */
+};
+
+
+static void usage(const char* name) {
+  std::cerr << "Usage: " << name << " <queries.ttq> [-j jobs] -- <solver command>" << std::endl;
+}
+
+
+static std::string recorded(triton::uint8 status) {
+  switch (status) {
+    case triton::engines::solver::SAT:     return "sat";
+    case triton::engines::solver::UNSAT:   return "unsat";
+    case triton::engines::solver::TIMEOUT: return "timeout";
+    default:                               return "unknown";
+  }
+}
+
+
+static void printDistribution(const std::string& name, std::vector<triton::usize> v) {
+  if (v.empty())
+    return;
+  std::sort(v.begin(), v.end());
+  triton::usize sum = 0;
+  for (const auto& ms : v) {
+    sum += ms;
+  }
+  auto pct = [&](double p) { return v[std::min(v.size() - 1, static_cast<triton::usize>(p * v.size()))]; };
+  std::cout << std::left << std::setw(10) << name
+            << " n: " << v.size()
+            << ",  min: " << v.front()
+            << ",  p50: " << pct(0.50)
+            << ",  p90: " << pct(0.90)
+            << ",  p99: " << pct(0.99)
+            << ",  max: " << v.back()
+            << ",  mean: " << (sum / v.size())
+            << ",  total: " << sum << " (ms)"
+            << std::endl;
+}
+
+
+int main(int ac, const char* av[]) {
+  std::string path;
+  std::string command;
+  triton::usize jobs = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i = 1; i < ac; i++) {
+    std::string arg = av[i];
+    if (arg == "-j" && i + 1 < ac) {
+      jobs = std::max(1, std::stoi(av[++i]));
+    }
+    else if (arg == "--") {
+      for (i++; i < ac; i++) {
+        command += std::string(av[i]) + " ";
+      }
+    }
+    else {
+      path = arg;
+    }
+  }
+
+  if (path.empty() || command.empty()) {
+    usage(av[0]);
+    return 1;
+  }
+
+  std::ifstream in(path, std::ios::binary);
+  if (QueryRecorder::readMagic(in) == false) {
+    std::cerr << "[TT] " << path << " is not a query file" << std::endl;
+    return 1;
+  }
+
+  std::vector<replay_s> queries;
+  replay_s q;
+  while (QueryRecorder::read(in, q.header, q.smt)) {
+    queries.push_back(q);
+  }
+  std::cout << "[TT] " << queries.size() << " queries loaded, replaying with " << jobs << " jobs" << std::endl;
+
+  /* Each worker takes the next query, writes its script and runs the solver on it */
+  std::atomic<triton::usize> next(0);
+  auto worker = [&](triton::usize id) {
+    std::string script = "/tmp/ttq-" + std::to_string(getpid()) + "-" + std::to_string(id) + ".smt2";
+    for (triton::usize i = next++; i < queries.size(); i = next++) {
+      auto& query = queries[i];
+      std::ofstream f(script);
+      if (query.header.timeout) {
+        f << "(set-option :timeout " << query.header.timeout * 1000 << ")" << std::endl;
+      }
+      f << query.smt;
+      f.close();
+
+      auto start = std::chrono::steady_clock::now();
+      FILE* p = popen((command + script + " 2>/dev/null").c_str(), "r");
+      std::string result;
+      if (p != nullptr) {
+        /* Solvers that do not know the timeout option answer it before the query */
+        char line[64] = {0};
+        while (fgets(line, sizeof(line), p) != nullptr) {
+          result = std::string(line).substr(0, std::string(line).find_first_of("\r\n"));
+          if (result != "unsupported" && result != "success")
+            break;
+          result.clear();
+        }
+        pclose(p);
+      }
+      query.ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      query.result = result;
+    }
+    std::remove(script.c_str());
+  };
+
+  std::vector<std::thread> threads;
+  for (triton::usize i = 0; i < jobs; i++) {
+    threads.push_back(std::thread(worker, i));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  /* Latency distributions, recorded and replayed, overall and per origin */
+  std::vector<triton::usize> before, after;
+  std::vector<triton::usize> enumBefore, enumAfter;
+  std::vector<std::vector<triton::usize>> byOrigin(sizeof(origins) / sizeof(origins[0]));
+  triton::usize sat = 0, unsat = 0, other = 0, mismatch = 0;
+
+  for (const auto& query : queries) {
+    /* The first check of an enumeration is not comparable to its recorded latency */
+    if (query.header.limit > 1) {
+      enumBefore.push_back(query.header.latency);
+      enumAfter.push_back(query.ms);
+    }
+    else {
+      before.push_back(query.header.latency);
+      after.push_back(query.ms);
+      if (query.header.origin < byOrigin.size()) {
+        byOrigin[query.header.origin].push_back(query.ms);
+      }
+    }
+    sat   += (query.result == "sat");
+    unsat += (query.result == "unsat");
+    other += (query.result != "sat" && query.result != "unsat");
+
+    /* A timeout of one side is not a disagreement */
+    auto rec = recorded(query.header.status);
+    if ((rec == "sat" || rec == "unsat") && (query.result == "sat" || query.result == "unsat") && rec != query.result) {
+      mismatch++;
+      std::cout << "[TT] Result mismatch at 0x" << std::hex << query.header.addr << std::dec
+                << " (" << origins[query.header.origin % byOrigin.size()] << "): recorded " << rec << ", replayed " << query.result << std::endl;
+    }
+  }
+
+  std::cout << "[TT] sat: " << sat << ",  unsat: " << unsat << ",  unknown/timeout/error: " << other << ",  mismatch: " << mismatch << std::endl;
+  printDistribution("recorded", before);
+  printDistribution("replayed", after);
+  for (triton::usize i = 0; i < byOrigin.size(); i++) {
+    printDistribution(origins[i], byOrigin[i]);
+  }
+
+  /* Enumerations: recorded for all the models, replayed for the first one only */
+  if (enumBefore.size()) {
+    std::cout << "[TT] " << enumBefore.size() << " enumerations of models (limit > 1), not compared:" << std::endl;
+    printDistribution("enum all", enumBefore);
+    printDistribution("enum 1st", enumAfter);
+  }
+
+  return 0;
+}
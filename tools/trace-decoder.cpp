@@ -0,0 +1,89 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+**  Jonathan Salwan
+*/
+
+/*
+ * Decode a trace recorded by the explorator (config.trace).
+ *
+ *   $ ./trace-decoder workspace/traces/42.trace       # one instruction per line
+ *   $ ./trace-decoder workspace/traces/42.trace -s    # summary only
+ *
+ * Taken branches are followed by a `*`.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <triton/exceptions.hpp>
+
+#include <trace.hpp>
+
+
+using triton::engines::exploration::TraceRecorder;
+using triton::engines::exploration::trace_entry_s;
+
+
+static void usage(const char* name) {
+  std::cerr << "Usage: " << name << " <file.trace> [-s]" << std::endl;
+}
+
+
+int main(int ac, const char* av[]) {
+  std::vector<trace_entry_s> entries;
+  triton::uint64 total = 0;
+  bool summary = false;
+
+  if (ac < 2 || (ac == 3 && std::strcmp(av[2], "-s") != 0) || ac > 3) {
+    usage(av[0]);
+    return -1;
+  }
+  summary = (ac == 3);
+
+  std::ifstream f(av[1], std::ios::binary);
+  if (f.is_open() == false) {
+    std::cerr << "Cannot open " << av[1] << std::endl;
+    return -1;
+  }
+
+  try {
+    if (TraceRecorder::decode(f, entries, total) == false) {
+      std::cerr << av[1] << " is not a trace file" << std::endl;
+      return -1;
+    }
+  }
+  catch (const triton::exceptions::Exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+
+  if (summary == false) {
+    for (const auto& entry : entries) {
+      std::cout << "0x" << std::hex << entry.pc << (entry.taken ? " *" : "") << std::endl;
+    }
+    return 0;
+  }
+
+  std::unordered_set<triton::uint64> pcs;
+  triton::usize taken = 0;
+  for (const auto& entry : entries) {
+    pcs.insert(entry.pc);
+    taken += entry.taken;
+  }
+
+  std::cout << std::dec;
+  std::cout << "executed: " << total << std::endl;
+  std::cout << "recorded: " << entries.size() << " (" << (total - entries.size()) << " dropped by the ring)" << std::endl;
+  std::cout << "unique:   " << pcs.size() << std::endl;
+  std::cout << "taken:    " << taken << std::endl;
+  if (entries.size()) {
+    std::cout << "last pc:  0x" << std::hex << entries.back().pc << std::endl;
+  }
+
+  return 0;
+}